@@ -492,13 +492,149 @@ type_struct_member_variable(struct type const* self, char const* name)
     return &self->data.struct_.member_variables[index];
 }
 
-struct type const*
-type_unique_function(
-    struct type const* const* parameter_types, struct type const* return_type)
+// Combine the hash of a structural type key with the next word of that key.
+// Type pointers are aligned, so the low bits of the result are mixed from the
+// high bits of the product to spread keys across the hash set.
+static unsigned long
+type_unique_hash_mix(unsigned long hash, uintmax_t word)
 {
-    assert(return_type != NULL);
+    hash = (hash ^ (unsigned long)word) * 0x9E3779B1ul;
+    return hash ^ (hash >> 16);
+}
+
+// Hash of the structural key of a pointer, array, slice, or function type.
+// The base of a function type is the return type of that function type.
+static unsigned long
+type_unique_hash(
+    enum type_kind kind,
+    struct type const* base,
+    uintmax_t count,
+    struct type const* const* parameter_types)
+{
+    unsigned long hash = (unsigned long)kind;
+    hash = type_unique_hash_mix(hash, (uintptr_t)base);
+    hash = type_unique_hash_mix(hash, count);
+    for (size_t i = 0; i < sbuf_count(parameter_types); ++i) {
+        hash = type_unique_hash_mix(hash, (uintptr_t)parameter_types[i]);
+    }
+    return hash;
+}
+
+static unsigned long
+type_unique_hash_type(struct type const* type)
+{
+    assert(type != NULL);
+
+    switch (type->kind) {
+    case TYPE_POINTER: {
+        return type_unique_hash(
+            TYPE_POINTER, type->data.pointer.base, 0u, NULL);
+    }
+    case TYPE_ARRAY: {
+        return type_unique_hash(
+            TYPE_ARRAY, type->data.array.base, type->data.array.count, NULL);
+    }
+    case TYPE_SLICE: {
+        return type_unique_hash(TYPE_SLICE, type->data.slice.base, 0u, NULL);
+    }
+    case TYPE_FUNCTION: {
+        return type_unique_hash(
+            TYPE_FUNCTION,
+            type->data.function.return_type,
+            sbuf_count(type->data.function.parameter_types),
+            type->data.function.parameter_types);
+    }
+    default: {
+        UNREACHABLE();
+    }
+    }
+
+    UNREACHABLE();
+    return 0;
+}
+
+static bool
+type_unique_matches(
+    struct type const* type,
+    enum type_kind kind,
+    struct type const* base,
+    uintmax_t count,
+    struct type const* const* parameter_types)
+{
+    assert(type != NULL);
+
+    if (type->kind != kind) {
+        return false;
+    }
+
+    switch (kind) {
+    case TYPE_POINTER: {
+        return type->data.pointer.base == base;
+    }
+    case TYPE_ARRAY: {
+        return type->data.array.base == base
+            && type->data.array.count == count;
+    }
+    case TYPE_SLICE: {
+        return type->data.slice.base == base;
+    }
+    case TYPE_FUNCTION: {
+        struct type const* const* const parameters =
+            type->data.function.parameter_types;
+        if (type->data.function.return_type != base
+            || sbuf_count(parameters) != count) {
+            return false;
+        }
+        for (size_t i = 0; i < sbuf_count(parameters); ++i) {
+            if (parameters[i] != parameter_types[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    default: {
+        UNREACHABLE();
+    }
+    }
+
+    UNREACHABLE();
+    return false;
+}
+
+// Returns the previously instantiated type with the provided structural key,
+// or NULL if no such type has been instantiated.
+static struct type const*
+type_unique_lookup(
+    enum type_kind kind,
+    struct type const* base,
+    uintmax_t count,
+    struct type const* const* parameter_types)
+{
+    sbuf(struct type const*) const elements =
+        context()->unique_types.elements;
+    unsigned long const hash =
+        type_unique_hash(kind, base, count, parameter_types);
+
+    for (size_t index = hash % sbuf_count(elements); elements[index] != NULL;
+         index = (index + 1) % sbuf_count(elements)) {
+        if (type_unique_matches(
+                elements[index], kind, base, count, parameter_types)) {
+            context()->unique_types.hits += 1;
+            return elements[index];
+        }
+    }
+
+    context()->unique_types.misses += 1;
+    return NULL;
+}
+
+// Register a newly created type with the global symbol table and the unique
+// types hash set, and return the registered type.
+static struct type const*
+type_unique_insert(struct type* type)
+{
+    assert(type != NULL);
 
-    struct type* const type = type_new_function(parameter_types, return_type);
     struct symbol const* const existing =
         symbol_table_lookup(context()->global_symbol_table, type->name);
     if (existing != NULL) {
@@ -513,30 +649,73 @@ type_unique_function(
     freeze(type);
     freeze(symbol);
     sbuf_push(context()->types, type);
+
+    // Insert at 50% occupancy, doubling the element count of the set when the
+    // set would become more than half full.
+    sbuf(struct type const*) elements = context()->unique_types.elements;
+    if (2 * (context()->unique_types.count + 1) > sbuf_count(elements)) {
+        sbuf(struct type const*) new = NULL;
+        sbuf_resize(new, sbuf_count(elements) * 2);
+        for (size_t i = 0; i < sbuf_count(new); ++i) {
+            new[i] = NULL;
+        }
+
+        for (size_t i = 0; i < sbuf_count(elements); ++i) {
+            if (elements[i] == NULL) {
+                continue;
+            }
+
+            size_t index = type_unique_hash_type(elements[i]) % sbuf_count(new);
+            while (new[index] != NULL) {
+                index = (index + 1) % sbuf_count(new);
+            }
+            new[index] = elements[i];
+        }
+
+        sbuf_fini(elements);
+        elements = new;
+        context()->unique_types.elements = new;
+    }
+
+    size_t index = type_unique_hash_type(type) % sbuf_count(elements);
+    while (elements[index] != NULL) {
+        index = (index + 1) % sbuf_count(elements);
+    }
+    elements[index] = type;
+    context()->unique_types.count += 1;
     return type;
 }
 
+struct type const*
+type_unique_function(
+    struct type const* const* parameter_types, struct type const* return_type)
+{
+    assert(return_type != NULL);
+
+    struct type const* const existing = type_unique_lookup(
+        TYPE_FUNCTION,
+        return_type,
+        sbuf_count(parameter_types),
+        parameter_types);
+    if (existing != NULL) {
+        return existing;
+    }
+
+    return type_unique_insert(type_new_function(parameter_types, return_type));
+}
+
 struct type const*
 type_unique_pointer(struct type const* base)
 {
     assert(base != NULL);
 
-    struct type* const type = type_new_pointer(base);
-    struct symbol const* const existing =
-        symbol_table_lookup(context()->global_symbol_table, type->name);
+    struct type const* const existing =
+        type_unique_lookup(TYPE_POINTER, base, 0u, NULL);
     if (existing != NULL) {
-        xalloc(type, XALLOC_FREE);
-        return symbol_xget_type(existing);
+        return existing;
     }
 
-    struct symbol* const symbol =
-        symbol_new_type(context()->builtin.location, type);
-    symbol_table_insert(
-        context()->global_symbol_table, symbol->name, symbol, false);
-    freeze(type);
-    freeze(symbol);
-    sbuf_push(context()->types, type);
-    return type;
+    return type_unique_insert(type_new_pointer(base));
 }
 
 struct type const*
@@ -545,28 +724,19 @@ type_unique_array(
 {
     assert(base != NULL);
 
+    struct type const* const existing =
+        type_unique_lookup(TYPE_ARRAY, base, count, NULL);
+    if (existing != NULL) {
+        return existing;
+    }
+
     uintmax_t const size = count * base->size;
     bool const size_overflow = count != 0 && size / count != base->size;
     if (size_overflow || size > SIZEOF_MAX) {
         fatal(location, "array size exceeds the maximum allowable object size");
     }
 
-    struct type* const type = type_new_array(count, base);
-    struct symbol const* const existing =
-        symbol_table_lookup(context()->global_symbol_table, type->name);
-    if (existing != NULL) {
-        xalloc(type, XALLOC_FREE);
-        return symbol_xget_type(existing);
-    }
-
-    struct symbol* const symbol =
-        symbol_new_type(context()->builtin.location, type);
-    symbol_table_insert(
-        context()->global_symbol_table, symbol->name, symbol, false);
-    freeze(type);
-    freeze(symbol);
-    sbuf_push(context()->types, type);
-    return type;
+    return type_unique_insert(type_new_array(count, base));
 }
 
 struct type const*
@@ -574,22 +744,13 @@ type_unique_slice(struct type const* base)
 {
     assert(base != NULL);
 
-    struct type* const type = type_new_slice(base);
-    struct symbol const* const existing =
-        symbol_table_lookup(context()->global_symbol_table, type->name);
+    struct type const* const existing =
+        type_unique_lookup(TYPE_SLICE, base, 0u, NULL);
     if (existing != NULL) {
-        xalloc(type, XALLOC_FREE);
-        return symbol_xget_type(existing);
+        return existing;
     }
 
-    struct symbol* const symbol =
-        symbol_new_type(context()->builtin.location, type);
-    symbol_table_insert(
-        context()->global_symbol_table, symbol->name, symbol, false);
-    freeze(type);
-    freeze(symbol);
-    sbuf_push(context()->types, type);
-    return type;
+    return type_unique_insert(type_new_slice(base));
 }
 
 struct symbol const*
@@ -719,6 +880,7 @@ address_init_local(char const* name, int rbp_offset)
     self.data.local.name = name;
     self.data.local.rbp_offset = rbp_offset;
     self.data.local.is_parameter = false;
+    self.data.local.is_initialized = false;
     return self;
 }
 
@@ -1001,12 +1163,14 @@ symbol_table_insert(
         struct symbol const* const local =
             symbol_table_lookup_local(self, name);
         if (local != NULL) {
+            struct source_position const position =
+                source_location_decode(local->location);
             fatal(
                 symbol->location,
                 "redeclaration of `%s` previously declared at [%s:%zu]",
                 name,
-                local->location.path,
-                local->location.line);
+                position.path,
+                position.line);
         }
     }
 
@@ -1610,8 +1774,10 @@ object_new(
 }
 
 struct function*
-function_new(struct type const* type, struct address const* address)
+function_new(
+    char const* name, struct type const* type, struct address const* address)
 {
+    assert(name != NULL);
     assert(type != NULL);
     assert(type->kind == TYPE_FUNCTION);
     assert(address != NULL);
@@ -1619,6 +1785,7 @@ function_new(struct type const* type, struct address const* address)
 
     struct function* const self = xalloc(NULL, sizeof(*self));
     memset(self, 0x00, sizeof(*self));
+    self->name = name;
     self->type = type;
     self->address = address;
     return self;
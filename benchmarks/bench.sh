@@ -0,0 +1,312 @@
+#!/bin/sh
+set -e
+
+PROGNAME=$(basename "$0")
+usage() {
+    cat <<EOF
+Usage: ${PROGNAME} [OPTION...] [BENCHMARK...]
+
+Options:
+  -b FILE   Compare results against the baseline results in FILE.
+  -n RUNS   Run each benchmark RUNS times, keeping the fastest (default 3).
+  -o FILE   Write results to FILE (default bench.json).
+  -r PCT    Report regressions slower than the baseline by PCT percent
+            (default 10).
+  -h        Display usage information and exit.
+
+Compiler benchmarks record the time spent in each compilation phase, as
+reported by \`sunder-compile -t\`, for the standard library and for a large
+synthetic module. Runtime benchmarks record the wall time of each benchmark
+program and variant in the benchmarks directory. Every benchmark is run with
+the C backend, and with the NASM backend when nasm is available.
+
+Results are written as a JSON array with one object per line. When a baseline
+is provided, the results are compared with benchmarks/compare.sh, and the exit
+status is non-zero if a regression is found.
+EOF
+}
+
+BASELINE= # empty
+RUNS=3
+RESULTS=bench.json
+THRESHOLD=10
+while getopts "b:hn:o:r:" opt; do
+case "${opt}" in
+    b)
+        BASELINE=$(realpath "${OPTARG}")
+        ;;
+    h)
+        usage
+        exit 0
+        ;;
+    n)
+        RUNS="${OPTARG}"
+        ;;
+    o)
+        RESULTS="${OPTARG}"
+        ;;
+    r)
+        THRESHOLD="${OPTARG}"
+        ;;
+    *)
+        usage >&2
+        exit 1
+        ;;
+esac
+done
+shift $((OPTIND - 1))
+
+if [ -z "${SUNDER_HOME}" ]; then
+    SUNDER_HOME=$(pwd)
+fi
+BENCHDIR=$(realpath "$(dirname "$0")")
+
+# Compiler benchmarks, as NAME FILE pairs. Files prefixed with "generated:"
+# are produced by generate-module.sh with the provided declaration count.
+COMPILER_BENCHMARKS=$(cat <<EOF
+std compile-std.sunder
+module-1000 generated:1000
+EOF
+)
+
+# Runtime benchmarks, one per line, as a benchmark name followed by the
+# arguments selecting a variant of that benchmark. A benchmark name suffixed
+# with +lto is compiled with `sunder-compile -f lto`, a benchmark name
+# suffixed with +unchecked is compiled with `sunder-compile -f lto
+# -f no-overflow-checks -f no-bounds-checks`, and a benchmark name suffixed
+# with +pgo is compiled with `sunder-compile -f profile-use` using the profile
+# of a training run of the same variant (C backend only).
+# Benchmarks with a C source file of the same name are linked against that
+# file, compiled with the C compiler used by the C backend (C backend only).
+RUNTIME_BENCHMARKS=$(cat <<EOF
+aggregate-copy
+aggregate-copy large
+big-integer
+big-integer+lto
+big-integer+unchecked
+binary-trees
+binary-trees global
+binary-trees+pgo
+byte-slice short
+byte-slice long
+byte-slice short scalar
+byte-slice long scalar
+ffi
+ffi+lto
+ieee754
+ieee754-csv
+integer
+io
+io buffered
+logging
+logging spec
+ordered-map
+ordered-map hash_map
+ordered-map+lto
+ordered-map+lto hash_map
+ordered-map+unchecked
+ordered-map+unchecked hash_map
+queue
+queue vector
+queue+lto
+queue+unchecked
+sort
+sort strings
+sort+lto
+sort+lto strings
+sort+unchecked
+sort+unchecked strings
+sort+pgo strings
+string-write
+string-write fresh
+word-frequency
+EOF
+)
+
+# C compiler used by the C backend, for benchmarks with a C source file.
+CC=$(SUNDER_BACKEND=C "${SUNDER_HOME}/bin/sunder-compile" -e \
+    | sed -n 's/^SUNDER_CC=//p')
+
+BACKENDS=C
+if [ "$(uname -m)" = "x86_64" ] && command -v nasm >/dev/null; then
+    BACKENDS="${BACKENDS} NASM"
+fi
+
+# Current time in milliseconds. GNU date supports nanoseconds, and other
+# implementations print a literal "N", in which case whole seconds are used.
+now_ms() {
+    NOW=$(date +%s%N)
+    case "${NOW}" in
+        *N)
+            echo $((${NOW%N} * 1000))
+            ;;
+        *)
+            echo $((NOW / 1000000))
+            ;;
+    esac
+}
+
+# Returns success if benchmark $1 was selected on the command line.
+selected() {
+    [ -z "${SELECTED}" ] && return 0
+    for s in ${SELECTED}; do
+        [ "${s}" = "$1" ] && return 0
+    done
+    return 1
+}
+SELECTED="$*"
+
+# Append a result object with benchmark $1, variant $2, backend $3, metric $4,
+# and time in milliseconds $5 to the results.
+result() {
+    if [ -s "${WORKDIR}/results" ]; then
+        echo ',' >>"${WORKDIR}/results"
+    fi
+    printf '{"benchmark": "%s", "variant": "%s", "backend": "%s", "metric": "%s", "ms": %s}' \
+        "$1" "$2" "$3" "$4" "$5" >>"${WORKDIR}/results"
+    printf '%-20s %-16s %-6s %-8s %12s ms\n' "$1" "$2" "$3" "$4" "$5"
+}
+
+# Compile benchmark $2 instrumented for profile-guided optimization, run the
+# training variant with arguments $3, and set PROFILE to the profile data file
+# of benchmark name $1.
+pgo_train() {
+    SUNDER_BACKEND=C "${SUNDER_HOME}/bin/sunder-compile" -f profile-generate \
+        -o "${WORKDIR}/$1.train" "${BENCHDIR}/$2.sunder" || return 1
+    # Word splitting of the variant arguments is intended.
+    # shellcheck disable=SC2086
+    LLVM_PROFILE_FILE="${WORKDIR}/$1.profraw" "${WORKDIR}/$1.train" $3 \
+        >/dev/null || return 1
+    case "${CC}" in
+        *clang*)
+            PROFILE="${WORKDIR}/$1.profdata"
+            llvm-profdata merge -o "${PROFILE}" "${WORKDIR}/$1.profraw"
+            ;;
+        *)
+            PROFILE="${WORKDIR}/$1.train.gcda"
+            ;;
+    esac
+}
+
+WORKDIR=$(mktemp -d)
+trap '{ rm -rf -- "${WORKDIR}"; }' EXIT
+: >"${WORKDIR}/results"
+cd "${WORKDIR}"
+
+for backend in ${BACKENDS}; do
+    echo "${COMPILER_BENCHMARKS}" | while read -r name file; do
+        selected "compile-${name}" || continue
+
+        case "${file}" in
+            generated:*)
+                sh "${BENCHDIR}/generate-module.sh" "${file#generated:}" \
+                    >"${WORKDIR}/${name}.sunder"
+                file="${WORKDIR}/${name}.sunder"
+                ;;
+            *)
+                file="${BENCHDIR}/${file}"
+                ;;
+        esac
+
+        # Keep the phase timings of the run with the fastest total.
+        BEST= # empty
+        RUN=0
+        while [ "${RUN}" -lt "${RUNS}" ]; do
+            RUN=$((RUN + 1))
+            if ! SUNDER_BACKEND="${backend}" "${SUNDER_HOME}/bin/sunder-compile" \
+                -t -o "${WORKDIR}/a.out" "${file}" 2>"${WORKDIR}/timings"; then
+                cat "${WORKDIR}/timings" >&2
+                echo "${PROGNAME}: failed to compile ${file}" >&2
+                exit 1
+            fi
+            TOTAL=$(awk '$1 == "total" { print $2 }' "${WORKDIR}/timings")
+            if [ -z "${BEST}" ] \
+            || awk "BEGIN { exit !(${TOTAL} < ${BEST}) }"; then
+                BEST="${TOTAL}"
+                cp "${WORKDIR}/timings" "${WORKDIR}/best"
+            fi
+        done
+
+        while read -r phase ms unit; do
+            # Skip the statistics that follow the phase timings.
+            [ "${unit}" = ms ] || continue
+            result "compile-${name}" "" "${backend}" "${phase}" "${ms}"
+        done <"${WORKDIR}/best"
+    done
+
+    echo "${RUNTIME_BENCHMARKS}" | while read -r name args; do
+        base="${name%+*}"
+        selected "${base}" || continue
+
+        FLAGS= # empty
+        CFLAGS=-O2
+        VARIANT="${args}"
+        OPTION="${name#"${base}"}"
+        if [ -n "${OPTION}" ]; then
+            [ "${backend}" = C ] || continue
+            VARIANT="${args:+${args} }${OPTION#+}"
+        fi
+        if [ "${OPTION}" = +lto ]; then
+            FLAGS="-f lto"
+            CFLAGS="${CFLAGS} -flto"
+        fi
+        if [ "${OPTION}" = +unchecked ]; then
+            FLAGS="-f lto -f no-overflow-checks -f no-bounds-checks"
+            CFLAGS="${CFLAGS} -flto"
+        fi
+        if [ -e "${BENCHDIR}/${base}.c" ]; then
+            [ "${backend}" = C ] || continue
+            # Word splitting of the C compiler flags is intended.
+            # shellcheck disable=SC2086
+            "${CC}" ${CFLAGS} -c -o "${WORKDIR}/${name}.o" "${BENCHDIR}/${base}.c"
+            FLAGS="${FLAGS} -l ${WORKDIR}/${name}.o"
+        fi
+
+        if [ "${OPTION}" = +pgo ] && [ ! -x "${WORKDIR}/${name}.${backend}" ]; then
+            if ! pgo_train "${name}" "${base}" "${args}"; then
+                echo "${PROGNAME}: skipping ${name} with backend ${backend}" >&2
+                continue
+            fi
+            FLAGS="-f profile-use=${PROFILE}"
+        fi
+
+        if [ ! -x "${WORKDIR}/${name}.${backend}" ]; then
+            # Word splitting of the compiler flags is intended.
+            # shellcheck disable=SC2086
+            if ! SUNDER_BACKEND="${backend}" "${SUNDER_HOME}/bin/sunder-compile" \
+                ${FLAGS} -o "${WORKDIR}/${name}.${backend}" \
+                "${BENCHDIR}/${base}.sunder"; then
+                echo "${PROGNAME}: skipping ${name} with backend ${backend}" >&2
+                continue
+            fi
+        fi
+
+        BEST= # empty
+        RUN=0
+        while [ "${RUN}" -lt "${RUNS}" ]; do
+            RUN=$((RUN + 1))
+            START=$(now_ms)
+            # Word splitting of the variant arguments is intended.
+            # shellcheck disable=SC2086
+            "${WORKDIR}/${name}.${backend}" ${args} >/dev/null
+            END=$(now_ms)
+            if [ -z "${BEST}" ] || [ $((END - START)) -lt "${BEST}" ]; then
+                BEST=$((END - START))
+            fi
+        done
+
+        result "${base}" "${VARIANT}" "${backend}" "run" "${BEST}"
+    done
+done
+
+cd - >/dev/null
+{
+    echo '['
+    cat "${WORKDIR}/results"
+    echo
+    echo ']'
+} >"${RESULTS}"
+
+if [ -n "${BASELINE}" ]; then
+    sh "${BENCHDIR}/compare.sh" -r "${THRESHOLD}" "${BASELINE}" "${RESULTS}"
+fi
@@ -0,0 +1,95 @@
+#!/bin/sh
+set -e
+
+PROGNAME=$(basename "$0")
+usage() {
+    cat <<EOF
+Usage: ${PROGNAME} [OPTION...] BASELINE RESULTS
+
+Compare benchmark results written by bench.sh against baseline results,
+reporting every benchmark measured in both files.
+
+Options:
+  -m MS     Ignore regressions of measurements faster than MS milliseconds in
+            both files (default 5).
+  -r PCT    Report regressions slower than the baseline by PCT percent
+            (default 10).
+  -h        Display usage information and exit.
+
+The exit status is non-zero if a regression is found.
+EOF
+}
+
+MINIMUM=5
+THRESHOLD=10
+while getopts "hm:r:" opt; do
+case "${opt}" in
+    h)
+        usage
+        exit 0
+        ;;
+    m)
+        MINIMUM="${OPTARG}"
+        ;;
+    r)
+        THRESHOLD="${OPTARG}"
+        ;;
+    *)
+        usage >&2
+        exit 1
+        ;;
+esac
+done
+shift $((OPTIND - 1))
+
+if [ "$#" -ne 2 ]; then
+    usage >&2
+    exit 1
+fi
+
+awk -v minimum="${MINIMUM}" -v threshold="${THRESHOLD}" '
+# Returns the value of the string field `name` in the result object `line`.
+function field(line, name,    start, rest) {
+    start = index(line, "\"" name "\": \"")
+    if (start == 0) {
+        return ""
+    }
+    rest = substr(line, start + length(name) + 5)
+    return substr(rest, 1, index(rest, "\"") - 1)
+}
+
+# Returns the value of the "ms" field in the result object `line`.
+function ms(line,    rest) {
+    rest = substr(line, index(line, "\"ms\": ") + 6)
+    sub(/[^0-9.].*$/, "", rest)
+    return rest + 0
+}
+
+/^\{/ {
+    key = sprintf("%-20s %-16s %-6s %-8s", \
+        field($0, "benchmark"), field($0, "variant"), \
+        field($0, "backend"), field($0, "metric"))
+    if (FILENAME == ARGV[1]) {
+        baseline[key] = ms($0)
+        next
+    }
+    if (!(key in baseline)) {
+        next
+    }
+
+    old = baseline[key]
+    new = ms($0)
+    change = old == 0 ? 0 : (new - old) * 100 / old
+    status = ""
+    if (change > threshold && (old >= minimum || new >= minimum)) {
+        status = " REGRESSION"
+        regressions += 1
+    }
+    printf("%s %12.3f %12.3f %+8.1f%%%s\n", key, old, new, change, status)
+}
+
+END {
+    printf("REGRESSIONS => %d\n", regressions)
+    exit regressions != 0
+}
+' "$1" "$2"
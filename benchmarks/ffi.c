@@ -0,0 +1,9 @@
+// SPDX-License-Identifier: Apache-2.0
+// C half of the FFI round-trip benchmark, see ffi.sunder.
+#include <stdint.h>
+
+uint64_t
+ffi_round_trip(uint64_t (*callback)(uint64_t), uint64_t value)
+{
+    return callback(value ^ (value >> 29)) + 1;
+}
@@ -0,0 +1,89 @@
+#!/bin/sh
+set -e
+
+PROGNAME=$(basename "$0")
+usage() {
+    cat <<EOF2
+Usage: ${PROGNAME} [COUNT]
+
+Write a synthetic Sunder module to standard output for benchmarking the
+compiler. The module contains COUNT (default 1000) groups of declarations, each
+made up of a struct with member functions, a function template instantiated
+for two types, and a function calling into the previous group.
+
+  \$ sh benchmarks/generate-module.sh 2000 >large.sunder
+  \$ sunder-compile -t -o large large.sunder
+EOF2
+}
+
+COUNT=1000
+if [ "$#" -ne 0 ]; then
+    case "$1" in
+        -h)
+            usage
+            exit 0
+            ;;
+        *)
+            COUNT="$1"
+            ;;
+    esac
+fi
+
+echo 'import "std";'
+I=0
+while [ "${I}" -lt "${COUNT}" ]; do
+    cat <<EOF2
+
+struct struct_${I} {
+    var x: u64;
+    var y: u64;
+
+    func init(x: u64, y: u64) struct_${I} {
+        return (:struct_${I}){.x = x, .y = y};
+    }
+
+    func sum(self: *struct_${I}) u64 {
+        return self.*.x +% self.*.y;
+    }
+
+    func mix(self: *struct_${I}, n: u64) u64 {
+        var result = self.*.x;
+        for i in (:usize)(n % 4) {
+            result = result *% 31 +% self.*.y +% (:u64)i;
+        }
+        return result;
+    }
+}
+
+func template_${I}[[T]](a: T, b: T) T {
+    if a < b {
+        return b -% a;
+    }
+    return a -% b;
+}
+
+func function_${I}(n: u64) u64 {
+    var s = struct_${I}::init(n, n *% ${I});
+    var result = s.sum() +% s.mix(n) +% template_${I}[[u64]](n, ${I});
+    result = result +% (:u64)template_${I}[[u32]]((:u32)(n % 65536), ${I});
+EOF2
+    if [ "${I}" -ne 0 ]; then
+        echo "    result = result +% function_$((I - 1))(n / 2);"
+    fi
+    cat <<EOF2
+    return result;
+}
+EOF2
+    I=$((I + 1))
+done
+
+cat <<EOF2
+
+func main() void {
+    var result = function_$((COUNT - 1))(${COUNT});
+    std::print_format_line(
+        std::out(),
+        "{}",
+        (:[]std::formatter)[std::formatter::init[[u64]](&result)]);
+}
+EOF2
@@ -9,7 +9,22 @@
 #include "sunder.h"
 
 static bool debug = false;
+static bool line_directives = false;
+static bool profile = false;
+// Runtime safety checks that are emitted into the generated C. Disabling
+// overflow checks lowers checked integer arithmetic to wrapping arithmetic,
+// and disabling bounds checks removes index and slice range checks.
+static bool bounds_checks = true;
+static bool overflow_checks = true;
 static struct string* out = NULL;
+// Path of the generated C source file and the number of lines of `out` that
+// have been counted, used to map lines back to the generated C source file
+// after line directives referencing Sunder source.
+static char const* out_path = NULL;
+static size_t out_counted_bytes = 0u;
+static size_t out_counted_lines = 0u;
+// Location of the most recently emitted line directive.
+static struct source_location out_line_directive = {0u};
 static unsigned indent = 0u;
 static struct function const* current_function = NULL;
 static struct stmt const* current_for_range_loop = NULL;
@@ -24,6 +39,10 @@ static char const* // interned
 mangle_local_symbol_name(struct symbol const* symbol);
 static char const* // interned
 mangle_symbol(struct symbol const* symbol);
+// Returns the name of the function symbol of symbol in the executable, which is
+// the assembler name given in the prototype of the function.
+static char const* // interned
+function_symbol_name(struct symbol const* symbol);
 
 static void
 indent_incr(void);
@@ -48,6 +67,10 @@ static APPENDF_LOCATION void
 appendli_location(struct source_location location, char const* fmt, ...);
 static void
 appendch(char ch);
+static void
+appendli_line_directive(struct source_location location);
+static void
+appendln_line_directive_reset(void);
 
 static void
 codegen_type_declaration(struct type const* type);
@@ -69,6 +92,11 @@ codegen_block(struct block const* block);
 static void
 codegen_defers(struct stmt const* begin, struct stmt const* end);
 
+static sbuf(char const*) // interned
+profile_flags(bool generate, char const* use, char const* out);
+static sbuf(char const*) // interned
+split_flags(char const* flags);
+
 static void
 codegen_stmt(struct stmt const* stmt);
 static void
@@ -92,6 +120,11 @@ codegen_stmt_assign(struct stmt const* stmt);
 static void
 codegen_stmt_expr(struct stmt const* stmt);
 
+static char const* // interned
+strgen_bounds_check(char const* condition);
+static char const* // interned
+strgen_negate_wrapping(struct expr const* rhs);
+
 static char const* // interned
 strgen_rvalue(struct expr const* expr);
 static char const* // interned
@@ -344,6 +377,19 @@ mangle_symbol(struct symbol const* symbol)
     UNREACHABLE();
 }
 
+static char const*
+function_symbol_name(struct symbol const* symbol)
+{
+    assert(symbol != NULL);
+    assert(symbol->kind == SYMBOL_FUNCTION);
+
+    char const* const name = symbol_xget_address(symbol)->data.static_.name;
+    if (name == context()->interned.main) {
+        return mangle_name(name);
+    }
+    return mangle(name);
+}
+
 static void
 indent_incr(void)
 {
@@ -406,15 +452,16 @@ static void
 appendli_location(struct source_location location, char const* fmt, ...)
 {
     assert(out != NULL);
-    assert(location.path != NO_PATH);
-    assert(location.line != NO_LINE);
-    assert(location.psrc != NO_PSRC);
+    struct source_position const position = source_location_decode(location);
+    assert(position.path != NO_PATH);
+    assert(position.line != NO_LINE);
+    assert(position.psrc != NO_PSRC);
 
     for (unsigned i = 0; i < indent; ++i) {
         string_append_cstr(out, "    ");
     }
 
-    string_append_fmt(out, "/// [%s:%zu] ", location.path, location.line);
+    string_append_fmt(out, "/// [%s:%zu] ", position.path, position.line);
 
     va_list args;
     va_start(args, fmt);
@@ -423,8 +470,8 @@ appendli_location(struct source_location location, char const* fmt, ...)
 
     string_append_cstr(out, "\n");
 
-    char const* const line_start = source_line_start(location.psrc);
-    char const* const line_end = source_line_end(location.psrc);
+    char const* const line_start = source_line_start(position.psrc);
+    char const* const line_end = source_line_end(position.psrc);
 
     for (unsigned i = 0; i < indent; ++i) {
         string_append_cstr(out, "    ");
@@ -435,7 +482,13 @@ appendli_location(struct source_location location, char const* fmt, ...)
     for (unsigned i = 0; i < indent; ++i) {
         string_append_cstr(out, "    ");
     }
-    string_append_fmt(out, "/// %*s^\n", (int)(location.psrc - line_start), "");
+    string_append_fmt(out, "/// %*s^\n", (int)(position.psrc - line_start), "");
+
+    // Debug comments shift the lines that follow, so the active line
+    // directive is re-emitted to keep generated code attributed to it.
+    if (line_directives && out_line_directive.id != NO_LOCATION.id) {
+        appendli_line_directive(out_line_directive);
+    }
 }
 
 static void
@@ -446,6 +499,82 @@ appendch(char ch)
     string_append(out, &ch, 1u);
 }
 
+static void
+append_line_directive_path(char const* path)
+{
+    assert(out != NULL);
+    assert(path != NULL);
+
+    appendch('"');
+    for (char const* cur = path; *cur != '\0'; ++cur) {
+        if (*cur == '"' || *cur == '\\') {
+            appendch('\\');
+        }
+        appendch(*cur);
+    }
+    appendch('"');
+}
+
+// Emit a line directive attributing the following line of generated C code to
+// the provided Sunder source location. The canonical path of the module
+// containing the location is used so that the directive is independent of the
+// directory from which the compiler was invoked.
+static void
+appendli_line_directive(struct source_location location)
+{
+    assert(out != NULL);
+
+    struct source_position const position = source_location_decode(location);
+    if (position.path == NO_PATH || position.line == NO_LINE) {
+        return;
+    }
+
+    char const* path = position.path;
+    if (position.psrc != NO_PSRC) {
+        sbuf(struct module*) const modules = context()->modules;
+        for (size_t i = 0; i < sbuf_count(modules); ++i) {
+            char const* const start = modules[i]->source;
+            char const* const end = start + modules[i]->source_count;
+            if (start <= position.psrc && position.psrc <= end) {
+                path = modules[i]->path;
+                break;
+            }
+        }
+    }
+
+    out_line_directive = location;
+    for (unsigned i = 0; i < indent; ++i) {
+        string_append_cstr(out, "    ");
+    }
+    append("#line %zu ", position.line);
+    append_line_directive_path(path);
+    appendch('\n');
+}
+
+// Emit a line directive attributing the following lines of generated C code
+// to their actual position within the generated C source file.
+static void
+appendln_line_directive_reset(void)
+{
+    assert(out != NULL);
+    assert(out_path != NULL);
+
+    char const* const start = string_start(out);
+    size_t const count = string_count(out);
+    for (size_t i = out_counted_bytes; i < count; ++i) {
+        if (start[i] == '\n') {
+            out_counted_lines += 1;
+        }
+    }
+    out_counted_bytes = count;
+    out_line_directive = NO_LOCATION;
+
+    // The directive itself occupies the line following the counted lines.
+    append("#line %zu ", out_counted_lines + 2);
+    append_line_directive_path(out_path);
+    appendch('\n');
+}
+
 static void
 codegen_type_declaration(struct type const* type)
 {
@@ -716,6 +845,9 @@ codegen_static_function(struct symbol const* symbol, bool prototype)
             params_written != 0 ? string_start(params) : "void");
     }
     else {
+        if (!prototype && line_directives) {
+            appendli_line_directive(symbol->location);
+        }
         append(
             "%s%c%s(%s)",
             mangle_type(function->type->data.function.return_type),
@@ -740,8 +872,37 @@ codegen_static_function(struct symbol const* symbol, bool prototype)
     appendch('\n');
     assert(current_function == NULL);
     current_function = function;
+    if (profile) {
+        // The function body is nested within a block holding the profile
+        // frame so that the frame cleanup runs on every return path.
+        char const* const record = mangle_name("__profile_function");
+        char const* const frame = mangle_name("__profile_frame");
+        if (line_directives) {
+            appendli_line_directive(symbol->location);
+        }
+        appendli("{");
+        indent_incr();
+        appendli(
+            "static struct %s %s = {.name = \"%s\"};",
+            record,
+            record,
+            function->name);
+        appendli(
+            "struct %s %s __attribute__((cleanup(%s)));",
+            frame,
+            frame,
+            mangle_name("__profile_leave"));
+        appendli("%s(&%s, &%s);", mangle_name("__profile_enter"), frame, record);
+    }
     codegen_block(&function->body);
+    if (profile) {
+        indent_decr();
+        appendli("}");
+    }
     current_function = NULL;
+    if (line_directives) {
+        appendln_line_directive_reset();
+    }
 }
 
 static char const*
@@ -818,7 +979,7 @@ strgen_value(struct value const* value)
             string_append_cstr(s, "(float)+INFINITY");
             break;
         }
-        string_append_fmt(s, "%.*ff", IEEE754_FLT_DECIMAL_DIG, ieee754);
+        string_append_fmt(s, "%.*ef", IEEE754_FLT_DECIMAL_DIG - 1, ieee754);
         break;
     }
     case TYPE_F64: {
@@ -835,7 +996,7 @@ strgen_value(struct value const* value)
             string_append_cstr(s, "(double)+INFINITY");
             break;
         }
-        string_append_fmt(s, "%.*f", IEEE754_DBL_DECIMAL_DIG, ieee754);
+        string_append_fmt(s, "%.*e", IEEE754_DBL_DECIMAL_DIG - 1, ieee754);
         break;
     }
     case TYPE_REAL: {
@@ -1063,6 +1224,10 @@ codegen_block(struct block const* block)
 {
     assert(block != NULL);
 
+    // Local variable initialization is attributed to the start of the block.
+    if (line_directives) {
+        appendli_line_directive(block->location);
+    }
     appendli("{");
     indent_incr();
 
@@ -1111,16 +1276,23 @@ codegen_block(struct block const* block)
         }
 
         appendli("// %s: %s", locals[i].name, type->name);
+        if (address->data.local.is_initialized) {
+            // The declaration of the local assigns its initial value before
+            // any use of the local, so it is not zero-initialized.
+            appendli(
+                "%s %s;",
+                mangle_type(type),
+                mangle_name(address->data.local.name));
+            continue;
+        }
+        // Struct padding is declared as explicit padding byte members of the
+        // generated C struct, so the uninit initializer also zero-initializes
+        // the padding of the local.
         appendli(
             "%s %s = %s;",
             mangle_type(type),
             mangle_name(address->data.local.name),
             strgen_uninit(type));
-        appendli(
-            "/* zero pading */%s(&%s, sizeof(%s));",
-            mangle_name("__memzero"),
-            mangle_name(address->data.local.name),
-            mangle_name(address->data.local.name));
     }
 
     // Generate statements.
@@ -1132,6 +1304,9 @@ codegen_block(struct block const* block)
     codegen_defers(block->defer_begin, block->defer_end);
     // Generate final return.
     if (generate_final_return) {
+        if (line_directives) {
+            appendli_line_directive(block->location);
+        }
         appendli("return %s;", mangle_name("return"));
     }
 
@@ -1164,6 +1339,9 @@ codegen_stmt(struct stmt const* stmt)
     if (debug) {
         appendli_location(stmt->location, "STATEMENT %s", cstr);
     }
+    if (line_directives) {
+        appendli_line_directive(stmt->location);
+    }
     table[stmt->kind].codegen_fn(stmt);
 }
 
@@ -1333,6 +1511,41 @@ codegen_stmt_expr(struct stmt const* stmt)
     appendli("%s;", strgen_rvalue(stmt->data.expr));
 }
 
+static char const*
+strgen_bounds_check(char const* condition)
+{
+    assert(condition != NULL);
+
+    if (!bounds_checks) {
+        return "/* bounds check elided */";
+    }
+    return intern_fmt(
+        "if (__builtin_expect(%s, 0)){%s();};",
+        condition,
+        mangle_name("__fatal_index_out_of_bounds"));
+}
+
+static char const*
+strgen_negate_wrapping(struct expr const* rhs)
+{
+    assert(rhs != NULL);
+    assert(type_is_sinteger(rhs->type));
+
+    // Negating a negative number that can not be represented as a positive
+    // number (e.g. T::MIN for signed integer type T) is undefined behavior in
+    // C, so implement negation "manually" using two's complement negation.
+    return intern_fmt(
+        "({%s %s = ~%s; %s_%s(%s, (%s)1);})",
+        mangle_type(rhs->type),
+        mangle_name("__result"),
+        strgen_rvalue(rhs),
+
+        mangle_name("__add_wrapping"),
+        mangle_type(rhs->type),
+        mangle_name("__result"),
+        mangle_type(rhs->type));
+}
+
 static char const*
 strgen_rvalue(struct expr const* expr)
 {
@@ -1597,19 +1810,11 @@ strgen_rvalue_struct(struct expr const* expr)
         goto done;
     }
 
+    // Struct padding is declared as explicit padding byte members of the
+    // generated C struct, so the padding omitted from the designated
+    // initializer is zero-initialized.
     string_append_fmt(
-        s,
-        "%s %s = (%s)%s; ",
-        mangle_type(expr->type),
-        mangle_name("__result"),
-        mangle_type(expr->type),
-        strgen_uninit(expr->type));
-    string_append_fmt(
-        s,
-        "/* zero padding */%s(&%s, sizeof(%s)); ",
-        mangle_name("__memzero"),
-        mangle_name("__result"),
-        mangle_name("__result"));
+        s, "%s %s = {", mangle_type(expr->type), mangle_name("__result"));
     for (size_t i = 0; i < sbuf_count(member_variable_defs); ++i) {
         if (member_variable_defs[i].type->size == 0) {
             continue;
@@ -1618,12 +1823,11 @@ strgen_rvalue_struct(struct expr const* expr)
             intern_fmt("__initializer_%s", member_variable_defs[i].name);
         string_append_fmt(
             s,
-            "%s.%s = %s; ",
-            mangle_name("__result"),
+            ".%s = %s, ",
             mangle_name(member_variable_defs[i].name),
             mangle_name(local));
     }
-    string_append_fmt(s, "%s;", mangle_name("__result"));
+    string_append_fmt(s, "}; %s;", mangle_name("__result"));
 
 done:
     string_append_cstr(s, "})");
@@ -1738,7 +1942,7 @@ strgen_rvalue_access_index(struct expr const* expr)
                 base_size);
 
         return intern_fmt(
-            "({%s %s = %s; %s %s = %s; if (%s >= %ju){%s();}; %s;})",
+            "({%s %s = %s; %s %s = %s; %s %s;})",
             lhs_type,
             mangle_name("__lhs"),
             strgen_rvalue(expr->data.access_index.lhs),
@@ -1747,9 +1951,10 @@ strgen_rvalue_access_index(struct expr const* expr)
             mangle_name("__idx"),
             strgen_rvalue(expr->data.access_index.idx),
 
-            mangle_name("__idx"),
-            expr->data.access_index.lhs->type->data.array.count,
-            mangle_name("__fatal_index_out_of_bounds"),
+            strgen_bounds_check(intern_fmt(
+                "%s >= %ju",
+                mangle_name("__idx"),
+                expr->data.access_index.lhs->type->data.array.count)),
 
             result);
     }
@@ -1769,9 +1974,7 @@ strgen_rvalue_access_index(struct expr const* expr)
                 base_size);
 
         return intern_fmt(
-            // clang-format off
-            "({%s %s = %s; %s %s = %s; if (%s >= %s.count){%s();}; %s;})",
-            // clang-format on
+            "({%s %s = %s; %s %s = %s; %s %s;})",
             mangle_type(expr->data.access_index.lhs->type),
             mangle_name("__lhs"),
             strgen_rvalue(expr->data.access_index.lhs),
@@ -1780,9 +1983,8 @@ strgen_rvalue_access_index(struct expr const* expr)
             mangle_name("__idx"),
             strgen_rvalue(expr->data.access_index.idx),
 
-            mangle_name("__idx"),
-            mangle_name("__lhs"),
-            mangle_name("__fatal_index_out_of_bounds"),
+            strgen_bounds_check(intern_fmt(
+                "%s >= %s.count", mangle_name("__idx"), mangle_name("__lhs"))),
 
             result);
     }
@@ -1818,6 +2020,10 @@ strgen_rvalue_access_slice(struct expr const* expr)
     // with uintptr_t to avoid this undefined behavior.
 
     if (expr->data.access_slice.lhs->type->kind == TYPE_ARRAY) {
+        // The array being sliced is always an lvalue. The address of the
+        // array must be used rather than the array value, as the value of an
+        // lvalue expression such as `ptr.*.array` may be a temporary copy.
+        assert(expr_is_lvalue(expr->data.access_slice.lhs));
         char const* start = NULL;
         if (lhs_is_zero_sized) {
             start = intern_fmt(
@@ -1828,15 +2034,15 @@ strgen_rvalue_access_slice(struct expr const* expr)
         }
         else {
             start = intern_fmt(
-                "(%s*)((uintptr_t)(%s).elements + ((uintptr_t)%s * %ju))",
+                "(%s*)((uintptr_t)(%s)->elements + ((uintptr_t)%s * %ju))",
                 mangle_type(expr->type->data.slice.base),
-                lexpr,
+                strgen_lvalue(expr->data.access_slice.lhs),
                 bname,
                 base_size);
         }
         char const* const count = intern_fmt("%s - %s", ename, bname);
         return intern_fmt(
-            "({%s %s = %s; %s %s = %s; if ((%s > %s) || (%s > %ju) || (%s > %ju)){%s();}; (%s){.start = %s, .count = %s};})",
+            "({%s %s = %s; %s %s = %s; %s (%s){.start = %s, .count = %s};})",
             btype,
             bname,
             bexpr,
@@ -1845,13 +2051,14 @@ strgen_rvalue_access_slice(struct expr const* expr)
             ename,
             eexpr,
 
-            bname,
-            ename,
-            bname,
-            expr->data.access_slice.lhs->type->data.array.count,
-            ename,
-            expr->data.access_slice.lhs->type->data.array.count,
-            mangle_name("__fatal_index_out_of_bounds"),
+            strgen_bounds_check(intern_fmt(
+                "(%s > %s) || (%s > %ju) || (%s > %ju)",
+                bname,
+                ename,
+                bname,
+                expr->data.access_slice.lhs->type->data.array.count,
+                ename,
+                expr->data.access_slice.lhs->type->data.array.count)),
 
             tname,
             start,
@@ -1868,7 +2075,7 @@ strgen_rvalue_access_slice(struct expr const* expr)
             base_size);
         char const* const count = intern_fmt("%s - %s", ename, bname);
         return intern_fmt(
-            "({%s %s = %s; %s %s = %s; %s %s = %s; if ((%s > %s) || (%s > %s.count) || (%s > %s.count)){%s();}; (%s){.start = %s, .count = %s};})",
+            "({%s %s = %s; %s %s = %s; %s %s = %s; %s (%s){.start = %s, .count = %s};})",
             ltype,
             lname,
             lexpr,
@@ -1881,13 +2088,14 @@ strgen_rvalue_access_slice(struct expr const* expr)
             ename,
             eexpr,
 
-            bname,
-            ename,
-            bname,
-            lname,
-            ename,
-            lname,
-            mangle_name("__fatal_index_out_of_bounds"),
+            strgen_bounds_check(intern_fmt(
+                "(%s > %s) || (%s > %s.count) || (%s > %s.count)",
+                bname,
+                ename,
+                bname,
+                lname,
+                ename,
+                lname)),
 
             tname,
             start,
@@ -2005,8 +2213,11 @@ strgen_rvalue_unary_neg(struct expr const* expr)
     }
 
     assert(type_is_sinteger(expr->data.unary.rhs->type));
+    if (!overflow_checks) {
+        return strgen_negate_wrapping(expr->data.unary.rhs);
+    }
     return intern_fmt(
-        "({%s %s = %s; if (%s == ((%s)(LLONG_MIN >> ((sizeof(long long) - sizeof(%s))*8)))){%s();}; -(%s);})",
+        "({%s %s = %s; if (__builtin_expect(%s == ((%s)(LLONG_MIN >> ((sizeof(long long) - sizeof(%s))*8))), 0)){%s();}; -(%s);})",
         mangle_type(expr->data.unary.rhs->type),
         mangle_name("__rhs"),
         strgen_rvalue(expr->data.unary.rhs),
@@ -2027,19 +2238,7 @@ strgen_rvalue_unary_neg_wrapping(struct expr const* expr)
     assert(expr->data.unary.op == UOP_NEG_WRAPPING);
     assert(type_is_sinteger(expr->data.unary.rhs->type));
 
-    // Negating a negative number that can not be represented as a positive
-    // number (e.g. T::MIN for signed integer type T) is undefined behavior in
-    // C, so implement negation "manually" using two's complement negation.
-    return intern_fmt(
-        "({%s %s = ~%s; %s_%s(%s, (%s)1);})",
-        mangle_type(expr->type),
-        mangle_name("__result"),
-        strgen_rvalue(expr->data.unary.rhs),
-
-        mangle_name("__add_wrapping"),
-        mangle_type(expr->type),
-        mangle_name("__result"),
-        mangle_type(expr->type));
+    return strgen_negate_wrapping(expr->data.unary.rhs);
 }
 
 static char const*
@@ -2419,7 +2618,7 @@ strgen_rvalue_binary_add(struct expr const* expr)
         mangle_name("__rhs"),
         strgen_rvalue(expr->data.binary.rhs),
 
-        mangle_name("__add"),
+        mangle_name(overflow_checks ? "__add" : "__add_wrapping"),
         mangle_type(expr->data.binary.lhs->type),
         mangle_name("__lhs"),
         mangle_name("__rhs"));
@@ -2476,7 +2675,7 @@ strgen_rvalue_binary_sub(struct expr const* expr)
         mangle_name("__rhs"),
         strgen_rvalue(expr->data.binary.rhs),
 
-        mangle_name("__sub"),
+        mangle_name(overflow_checks ? "__sub" : "__sub_wrapping"),
         mangle_type(expr->data.binary.lhs->type),
         mangle_name("__lhs"),
         mangle_name("__rhs"));
@@ -2533,7 +2732,7 @@ strgen_rvalue_binary_mul(struct expr const* expr)
         mangle_name("__rhs"),
         strgen_rvalue(expr->data.binary.rhs),
 
-        mangle_name("__mul"),
+        mangle_name(overflow_checks ? "__mul" : "__mul_wrapping"),
         mangle_type(expr->data.binary.lhs->type),
         mangle_name("__lhs"),
         mangle_name("__rhs"));
@@ -2737,7 +2936,7 @@ strgen_lvalue_access_index(struct expr const* expr)
             ? intern_fmt("((%s*)0)", mangle_type(expr->type))
             : intern_fmt("%s->elements", mangle_name("__lhs"));
         return intern_fmt(
-            "({%s* %s = %s; %s %s = %s; if (%s >= %ju){%s();}; (%s*)((uintptr_t)%s + (%s * %ju));})",
+            "({%s* %s = %s; %s %s = %s; %s (%s*)((uintptr_t)%s + (%s * %ju));})",
             lhs_type,
             mangle_name("__lhs"),
             strgen_lvalue(expr->data.access_index.lhs),
@@ -2746,9 +2945,10 @@ strgen_lvalue_access_index(struct expr const* expr)
             mangle_name("__idx"),
             strgen_rvalue(expr->data.access_index.idx),
 
-            mangle_name("__idx"),
-            expr->data.access_index.lhs->type->data.array.count,
-            mangle_name("__fatal_index_out_of_bounds"),
+            strgen_bounds_check(intern_fmt(
+                "%s >= %ju",
+                mangle_name("__idx"),
+                expr->data.access_index.lhs->type->data.array.count)),
 
             mangle_type(expr->type),
             elements,
@@ -2760,7 +2960,7 @@ strgen_lvalue_access_index(struct expr const* expr)
         uintmax_t const base_size =
             expr->data.access_index.lhs->type->data.slice.base->size;
         return intern_fmt(
-            "({%s %s = %s; %s %s = %s; if (%s >= %s.count){%s();}; (%s*)((uintptr_t)%s.start + (%s * %ju));})",
+            "({%s %s = %s; %s %s = %s; %s (%s*)((uintptr_t)%s.start + (%s * %ju));})",
             mangle_type(expr->data.access_index.lhs->type),
             mangle_name("__lhs"),
             strgen_rvalue(expr->data.access_index.lhs),
@@ -2769,9 +2969,8 @@ strgen_lvalue_access_index(struct expr const* expr)
             mangle_name("__idx"),
             strgen_rvalue(expr->data.access_index.idx),
 
-            mangle_name("__idx"),
-            mangle_name("__lhs"),
-            mangle_name("__fatal_index_out_of_bounds"),
+            strgen_bounds_check(intern_fmt(
+                "%s >= %s.count", mangle_name("__idx"), mangle_name("__lhs"))),
 
             mangle_type(expr->type),
             mangle_name("__lhs"),
@@ -2838,11 +3037,111 @@ codegen_defers(struct stmt const* begin, struct stmt const* end)
     }
 }
 
+static sbuf(char const*)
+profile_flags(bool generate, char const* use, char const* out)
+{
+    assert(generate != (use != NULL));
+    assert(out != NULL);
+
+    sbuf(char const*) flags = NULL;
+    if (strstr(context()->env.SUNDER_CC, "clang") != NULL) {
+        // Clang writes raw profiles to default_%m.profraw (or to the path in
+        // LLVM_PROFILE_FILE), which are merged into the indexed profile FILE
+        // with llvm-profdata.
+        sbuf_push(
+            flags,
+            generate ? "-fprofile-generate"
+                     : intern_fmt("-fprofile-use=%s", use));
+        return flags;
+    }
+
+    // GCC names profile data after the auxiliary output base name, which
+    // would otherwise be derived from the temporary C file. The program is
+    // instrumented to write OUT.gcda, and FILE.gcda is read as the profile
+    // data of FILE.
+    char const* path = out;
+    if (!generate) {
+        if (!cstr_ends_with(use, ".gcda")) {
+            fatal(
+                NO_LOCATION,
+                "profile data file `%s` does not have a .gcda extension",
+                use);
+        }
+        path = intern(use, strlen(use) - STR_LITERAL_COUNT(".gcda"));
+    }
+    char const* const slash = strrchr(path, '/');
+    char const* const dir =
+        slash != NULL ? intern(path, (size_t)(slash - path) + 1) : "./";
+    char const* const base = slash != NULL ? slash + 1 : path;
+
+    sbuf_push(flags, generate ? "-fprofile-generate" : "-fprofile-use");
+    sbuf_push(flags, "-dumpdir");
+    sbuf_push(flags, dir);
+    sbuf_push(flags, "-dumpbase");
+    sbuf_push(flags, base);
+    return flags;
+}
+
+static sbuf(char const*)
+split_flags(char const* flags)
+{
+    assert(flags != NULL);
+
+    // Flags are separated by whitespace. Whitespace within single or double
+    // quotes or preceded by a backslash is part of the flag, as in sh.
+    sbuf(char const*) split = NULL;
+    struct string* const flag = string_new(NULL, 0);
+    char const* cur = flags;
+    while (true) {
+        while (safe_isspace(*cur)) {
+            cur += 1;
+        }
+        if (*cur == '\0') {
+            break;
+        }
+
+        string_resize(flag, 0);
+        char quote = '\0';
+        for (; *cur != '\0'; ++cur) {
+            if (quote == '\0' && safe_isspace(*cur)) {
+                break;
+            }
+            if (quote == '\0' && (*cur == '\'' || *cur == '"')) {
+                quote = *cur;
+                continue;
+            }
+            if (quote != '\0' && *cur == quote) {
+                quote = '\0';
+                continue;
+            }
+            if (quote != '\'' && *cur == '\\' && cur[1] != '\0') {
+                cur += 1;
+            }
+            string_append(flag, cur, 1);
+        }
+        if (quote != '\0') {
+            fatal(NO_LOCATION, "unterminated quote in SUNDER_CFLAGS");
+        }
+
+        sbuf_push(split, intern(string_start(flag), string_count(flag)));
+    }
+    string_del(flag);
+    return split;
+}
+
 void
 codegen_c(
     bool opt_c,
+    bool opt_flto,
+    bool opt_fprofile_generate,
+    char const* opt_fprofile_use,
+    bool opt_fno_bounds_checks,
+    bool opt_fno_overflow_checks,
     bool opt_g,
     bool opt_k,
+    bool opt_m,
+    bool opt_p,
+    bool opt_s,
     char const* const* opt_L,
     char const* const* opt_l,
     char const* const opt_o)
@@ -2854,8 +3153,21 @@ codegen_c(
     (void)backend;
 
     debug = opt_g;
+    // Profile data is matched to functions by their names, which are derived
+    // from qualified Sunder names, and by their source locations, which are
+    // taken from the Sunder source, so that profile data remains valid across
+    // rebuilds with unrelated changes to the generated C.
+    line_directives =
+        opt_s || opt_fprofile_generate || opt_fprofile_use != NULL;
+    profile = opt_p;
+    bounds_checks = !opt_fno_bounds_checks;
+    overflow_checks = !opt_fno_overflow_checks;
     out = string_new(NULL, 0u);
     struct string* const src_path = string_new_fmt("%s.tmp.c", opt_o);
+    out_path = string_start(src_path);
+    out_counted_bytes = 0u;
+    out_counted_lines = 0u;
+    out_line_directive = NO_LOCATION;
     struct string* const obj_path = string_new_fmt("%s.tmp.o", opt_o);
 
     char const* const SUNDER_HOME = getenv("SUNDER_HOME");
@@ -2874,7 +3186,32 @@ codegen_c(
         sbuf_push(backend_argv, "-o");
         sbuf_push(backend_argv, opt_o);
     }
-    sbuf_push(backend_argv, "-O0");
+    if (opt_flto || opt_fprofile_generate || opt_fprofile_use != NULL) {
+        // Sunder allows arbitrary pointer casts, so type-based alias analysis
+        // is disabled. Frame pointers are kept so that sys::backtrace and
+        // frame-pointer unwinding profilers continue to work in optimized
+        // code.
+        sbuf_push(backend_argv, "-O2");
+        sbuf_push(backend_argv, "-fno-strict-aliasing");
+        sbuf_push(backend_argv, "-fno-omit-frame-pointer");
+    }
+    else {
+        sbuf_push(backend_argv, "-O0");
+    }
+    if (opt_flto) {
+        // Emit LTO bytecode instead of machine code so that the generated C
+        // is optimized together with user-provided C objects and archives
+        // compiled with -flto when the program is linked.
+        sbuf_push(backend_argv, "-flto=auto");
+    }
+    if (opt_fprofile_generate || opt_fprofile_use != NULL) {
+        sbuf(char const*) const flags =
+            profile_flags(opt_fprofile_generate, opt_fprofile_use, opt_o);
+        for (size_t i = 0; i < sbuf_count(flags); ++i) {
+            sbuf_push(backend_argv, flags[i]);
+        }
+        sbuf_fini(flags);
+    }
     if (opt_g) {
         sbuf_push(backend_argv, "-g");
     }
@@ -2931,24 +3268,25 @@ codegen_c(
         }
         sbuf_push(backend_argv, "-lm");
         for (size_t i = 0; i < sbuf_count(opt_l); ++i) {
+            // Object files and archives are passed to the link as input
+            // files, and are therefore visible to link-time optimization.
+            if (is_raw_linker_argument(opt_l[i])) {
+                sbuf_push(backend_argv, opt_l[i]);
+                continue;
+            }
             sbuf_push(backend_argv, intern_fmt("-l%s", opt_l[i]));
         }
     }
-    struct string* const flags = string_new_cstr(context()->env.SUNDER_CFLAGS);
-    sbuf(struct string*) const split =
-        string_split(flags, " ", STR_LITERAL_COUNT(" "));
-    for (size_t i = 0; i < sbuf_count(split); ++i) {
-        if (string_count(split[i]) != 0) {
-            sbuf_push(
-                backend_argv,
-                intern(string_start(split[i]), string_count(split[i])));
-        }
-        string_del(split[i]);
+    sbuf(char const*) const flags = split_flags(context()->env.SUNDER_CFLAGS);
+    for (size_t i = 0; i < sbuf_count(flags); ++i) {
+        sbuf_push(backend_argv, flags[i]);
     }
-    sbuf_fini(split);
-    string_del(flags);
+    sbuf_fini(flags);
     sbuf_push(backend_argv, (char const*)NULL);
 
+    if (opt_p) {
+        appendln("#define __SUNDER_PROFILE");
+    }
     appendln("#include \"sys.h\"");
     appendch('\n');
     // Generate forward type declarations.
@@ -3001,6 +3339,9 @@ codegen_c(
         appendli("sys_argv = argv;");
         appendli("sys_envp = envp;");
         appendli("%s();", mangle_name(context()->interned.main));
+        if (opt_p) {
+            appendli("%s();", mangle_name("__profile_write"));
+        }
         appendli("return 0;");
         indent_decr();
         appendln("}");
@@ -3017,10 +3358,18 @@ codegen_c(
         goto cleanup;
     }
 
-    if ((err = spawnvpw(backend_argv))) {
+    enum phase const suspended = phase_enter(PHASE_BACKEND);
+    err = spawnvpw(backend_argv);
+    phase_leave(suspended);
+    if (err) {
         goto cleanup;
     }
 
+    if (opt_m && !opt_c) {
+        err = write_perf_map(
+            opt_o, intern_fmt("%s.map", opt_o), function_symbol_name);
+    }
+
 cleanup:
     if (!opt_k) {
         (void)remove(string_start(src_path));
@@ -3030,6 +3379,7 @@ cleanup:
     }
     sbuf_fini(backend_argv);
     string_del(src_path);
+    out_path = NULL;
     string_del(obj_path);
     string_del(out);
     if (err) {
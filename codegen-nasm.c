@@ -8,10 +8,13 @@
 #include "sunder.h"
 
 static bool debug = false;
+static bool profile = false;
 static struct string* out = NULL;
 static struct function const* current_function = NULL;
 static size_t current_loop_id; // Used for generating break & continue labels.
 static size_t unique_id = 0; // Used for generating unique names and labels.
+// Unique IDs of the epilogues in the current function, for unwind information.
+static sbuf(size_t) current_epilogues = NULL;
 
 // Local labels take the form:
 //      .__<AST-node-type>_<unique-id>_<description>
@@ -32,6 +35,29 @@ static size_t unique_id = 0; // Used for generating unique names and labels.
 // node for use as a jump target.
 #define LABEL_STMT ".__STMT_"
 #define LABEL_EXPR ".__EXPR_"
+// Local label marking the end of a function, used to compute the size of the
+// function symbol and the address range of the function's unwind information.
+#define LABEL_FUNCTION_END ".__END"
+// Local label placed between the `pop rbp` and `ret` instructions of a function
+// epilogue, followed by the unique ID of the epilogue.
+#define LABEL_EPILOGUE ".__EPILOGUE_"
+// Size in bytes at and above which aggregate copies and local stack
+// initialization are performed with a string instruction (rep movsq or rep
+// stosq) rather than an unrolled sequence of moves. An unrolled copy of N bytes
+// is about N/4 instructions, while a string copy is at most ten instructions
+// regardless of size. The startup cost of a string instruction makes it slower
+// than an unrolled copy for aggregates of up to a few hundred bytes, such as
+// the std::result and std::optional values and B-tree nodes of the standard
+// library, so smaller copies remain unrolled.
+#define COPY_STRING_MIN 512u
+// Local labels of the profile record and name of a function instrumented with
+// `sunder-compile -p`.
+#define LABEL_PROFILE_FUNCTION ".__PROFILE_FUNCTION"
+#define LABEL_PROFILE_NAME ".__PROFILE_NAME"
+// Size in bytes of the profile frame reserved at the bottom of the local stack
+// space of a function instrumented with `sunder-compile -p`. See the builtin
+// profiler subroutines of sys.asm for the layout of the frame.
+#define PROFILE_FRAME_SIZE 0x20u
 
 #if defined(__GNUC__) /* GCC and Clang */
 #    define APPENDF __attribute__((format(printf, 1, 2)))
@@ -79,6 +105,12 @@ reg_b(uintmax_t size);
 static char const*
 reg_c(uintmax_t size);
 
+// Copy size bytes from the address in register src to the address in register
+// dst. Copies smaller than COPY_STRING_MIN bytes are unrolled into moves using
+// rcx for intermediate storage. Larger copies are performed with a string copy
+// (rep movsq) that additionally clobbers rsi and rdi.
+static void
+copy_via_rcx(char const* src, char const* dst, uintmax_t size);
 // Copy size bytes from the address in rax to to the address in rbx using rcx
 // for intermediate storage. Roughly equivalent to memcpy(rbx, rax, size).
 static void
@@ -97,6 +129,21 @@ copy_rax_rsp_via_rcx(uintmax_t size);
 static void
 mov_rax_reg_a_with_zero_or_sign_extend(struct type const* type);
 
+// Scalar SSE instruction suffix (ss or sd) based on IEEE-754 type.
+static char const*
+sse_suffix(struct type const* type);
+// Pop the rhs and lhs of a binary expression with IEEE-754 operands into xmm1
+// and xmm0 respectively, clobbering rax and rbx.
+static void
+pop_xmm0_xmm1_ieee754(struct type const* type);
+// Push the IEEE-754 value in xmm0, clobbering rax.
+static void
+push_xmm0_ieee754(struct type const* type);
+// Move the constant value, rounded to the IEEE-754 type, into register xmm,
+// clobbering rax.
+static void
+mov_xmm_ieee754(char const* xmm, struct type const* type, double value);
+
 static void
 append(char const* fmt, ...)
 {
@@ -143,11 +190,12 @@ static void
 appendli_location(struct source_location location, char const* fmt, ...)
 {
     assert(out != NULL);
-    assert(location.path != NO_PATH);
-    assert(location.line != NO_LINE);
-    assert(location.psrc != NO_PSRC);
+    struct source_position const position = source_location_decode(location);
+    assert(position.path != NO_PATH);
+    assert(position.line != NO_LINE);
+    assert(position.psrc != NO_PSRC);
 
-    string_append_fmt(out, "    ; [%s:%zu] ", location.path, location.line);
+    string_append_fmt(out, "    ; [%s:%zu] ", position.path, position.line);
 
     va_list args;
     va_start(args, fmt);
@@ -156,13 +204,13 @@ appendli_location(struct source_location location, char const* fmt, ...)
 
     string_append_cstr(out, "\n");
 
-    char const* const line_start = source_line_start(location.psrc);
-    char const* const line_end = source_line_end(location.psrc);
+    char const* const line_start = source_line_start(position.psrc);
+    char const* const line_end = source_line_end(position.psrc);
 
     string_append_fmt(
         out, "    ;%.*s\n", (int)(line_end - line_start), line_start);
     string_append_fmt(
-        out, "    ;%*s^\n", (int)(location.psrc - line_start), "");
+        out, "    ;%*s^\n", (int)(position.psrc - line_start), "");
 }
 
 static void
@@ -436,6 +484,13 @@ push_at_address(uintmax_t size, struct address const* address)
         UNREACHABLE();
     }
 
+    if (size >= COPY_STRING_MIN) {
+        appendli("lea rax, [%s]", addr);
+        copy_rax_rsp_via_rcx(size);
+        xalloc(addr, XALLOC_FREE);
+        return;
+    }
+
     uintmax_t cur = 0u;
     while ((size - cur) >= 8u) {
         appendli("mov rax, [%s + %#jx]", addr, cur);
@@ -525,84 +580,64 @@ reg_c(uintmax_t size)
 }
 
 static void
-copy_rax_rbx_via_rcx(uintmax_t size)
+copy_via_rcx(char const* src, char const* dst, uintmax_t size)
 {
+    assert(src != NULL);
+    assert(dst != NULL);
+
     uintmax_t cur = 0u;
+    if (size >= COPY_STRING_MIN) {
+        // The string copy leaves rsi and rdi pointing one past the last
+        // copied quadword, so the remaining bytes are copied relative to the
+        // string copy registers.
+        appendli("mov rsi, %s", src);
+        appendli("mov rdi, %s", dst);
+        appendli("mov rcx, %#jx", size / 8u);
+        appendli("rep movsq");
+        src = "rsi";
+        dst = "rdi";
+        size = size % 8u;
+    }
+
     while ((size - cur) >= 8u) {
-        appendli("mov rcx, [rax + %#jx]", cur);
-        appendli("mov [rbx + %#jx], rcx", cur);
+        appendli("mov rcx, [%s + %#jx]", src, cur);
+        appendli("mov [%s + %#jx], rcx", dst, cur);
         cur += 8u;
     }
     if ((size - cur) >= 4u) {
-        appendli("mov ecx, [rax + %#jx]", cur);
-        appendli("mov [rbx + %#jx], ecx", cur);
+        appendli("mov ecx, [%s + %#jx]", src, cur);
+        appendli("mov [%s + %#jx], ecx", dst, cur);
         cur += 4u;
         assert((size - cur) < 4u);
     }
     if ((size - cur) >= 2u) {
-        appendli("mov cx, [rax + %#jx]", cur);
-        appendli("mov [rbx + %#jx], cx", cur);
+        appendli("mov cx, [%s + %#jx]", src, cur);
+        appendli("mov [%s + %#jx], cx", dst, cur);
         cur += 2u;
         assert((size - cur) < 2u);
     }
     if ((size - cur) == 1u) {
-        appendli("mov cl, [rax + %#jx]", cur);
-        appendli("mov [rbx + %#jx], cl", cur);
+        appendli("mov cl, [%s + %#jx]", src, cur);
+        appendli("mov [%s + %#jx], cl", dst, cur);
     }
 }
 
+static void
+copy_rax_rbx_via_rcx(uintmax_t size)
+{
+    copy_via_rcx("rax", "rbx", size);
+}
+
 static void
 copy_rsp_rbx_via_rcx(uintmax_t size)
 {
-    uintmax_t cur = 0u;
-    while ((size - cur) >= 8u) {
-        appendli("mov rcx, [rsp + %#jx]", cur);
-        appendli("mov [rbx + %#jx], rcx", cur);
-        cur += 8u;
-    }
-    if ((size - cur) >= 4u) {
-        appendli("mov ecx, [rsp + %#jx]", cur);
-        appendli("mov [rbx + %#jx], ecx", cur);
-        cur += 4u;
-        assert((size - cur) < 4u);
-    }
-    if ((size - cur) >= 2u) {
-        appendli("mov cx, [rsp + %#jx]", cur);
-        appendli("mov [rbx + %#jx], cx", cur);
-        cur += 2u;
-        assert((size - cur) < 2u);
-    }
-    if ((size - cur) == 1u) {
-        appendli("mov cl, [rsp + %#jx]", cur);
-        appendli("mov [rbx + %#jx], cl", cur);
-    }
+    copy_via_rcx("rsp", "rbx", size);
 }
 
 static void
 copy_rax_rsp_via_rcx(uintmax_t size)
 {
-    uintmax_t cur = 0u;
-    while ((size - cur) >= 8u) {
-        appendli("mov rcx, [rax + %#jx]", cur);
-        appendli("mov [rsp + %#jx], rcx", cur);
-        cur += 8u;
-    }
-    if ((size - cur) >= 4u) {
-        appendli("mov ecx, [rax + %#jx]", cur);
-        appendli("mov [rsp + %#jx], ecx", cur);
-        cur += 4u;
-        assert((size - cur) < 4u);
-    }
-    if ((size - cur) >= 2u) {
-        appendli("mov cx, [rax + %#jx]", cur);
-        appendli("mov [rsp + %#jx], cx", cur);
-        cur += 2u;
-        assert((size - cur) < 2u);
-    }
-    if ((size - cur) == 1u) {
-        appendli("mov cl, [rax + %#jx]", cur);
-        appendli("mov [rsp + %#jx], cl", cur);
-    }
+    copy_via_rcx("rax", "rsp", size);
 }
 
 static void
@@ -665,6 +700,71 @@ mov_rax_reg_a_with_zero_or_sign_extend(struct type const* type)
     }
 }
 
+static char const*
+sse_suffix(struct type const* type)
+{
+    assert(type_is_ieee754(type));
+    return type->kind == TYPE_F32 ? "ss" : "sd";
+}
+
+static void
+pop_xmm0_xmm1_ieee754(struct type const* type)
+{
+    assert(type_is_ieee754(type));
+
+    // MOVD moves a doubleword and MOVQ moves a quadword between a general
+    // purpose register and the low bits of an XMM register.
+    char const* const mov = type->kind == TYPE_F32 ? "movd" : "movq";
+    appendli("pop rbx ; rhs");
+    appendli("pop rax ; lhs");
+    appendli("%s xmm0, %s", mov, reg_a(type->size));
+    appendli("%s xmm1, %s", mov, reg_b(type->size));
+}
+
+static void
+push_xmm0_ieee754(struct type const* type)
+{
+    assert(type_is_ieee754(type));
+
+    char const* const mov = type->kind == TYPE_F32 ? "movd" : "movq";
+    appendli("%s %s, xmm0", mov, reg_a(type->size));
+    appendli("push rax");
+}
+
+static void
+mov_xmm_ieee754(char const* xmm, struct type const* type, double value)
+{
+    assert(xmm != NULL);
+    assert(type_is_ieee754(type));
+
+    if (type->kind == TYPE_F32) {
+        union {
+            float f32;
+            uint32_t u32;
+        } u;
+        u.f32 = (float)value;
+        appendli(
+            "mov eax, %" PRIu32 " ; (%.*f as an integer)",
+            u.u32,
+            IEEE754_FLT_DECIMAL_DIG,
+            (double)u.f32);
+        appendli("movd %s, eax", xmm);
+        return;
+    }
+
+    union {
+        double f64;
+        uint64_t u64;
+    } u;
+    u.f64 = value;
+    appendli(
+        "mov rax, %" PRIu64 " ; (%.*f as an integer)",
+        u.u64,
+        IEEE754_DBL_DECIMAL_DIG,
+        u.f64);
+    appendli("movq %s, rax", xmm);
+}
+
 // Populates an xalloc-allocated buffer.
 static void
 load_sysasm(void** buf, size_t* buf_size);
@@ -686,6 +786,21 @@ static void
 codegen_static_object(struct symbol const* symbol);
 static void
 codegen_static_function(struct symbol const* symbol);
+// Emit DWARF call frame information into the .eh_frame section so that
+// debuggers and sampling profilers are able to unwind the stack.
+static void
+codegen_eh_frame_cie(void);
+static void
+codegen_eh_frame_fde(struct address const* address);
+// Emit a function epilogue returning control to the calling routine.
+static void
+codegen_epilogue(void);
+// Emit the profile record of a function instrumented with `sunder-compile -p`.
+static void
+codegen_profile_function(struct function const* function);
+// Returns the name of the function symbol of symbol in the executable.
+static char const* // interned
+function_symbol_name(struct symbol const* symbol);
 
 static void
 codegen_block(struct block const* block);
@@ -734,8 +849,18 @@ static void
 push_rvalue_struct(struct expr const* expr, size_t id);
 static void
 push_rvalue_cast(struct expr const* expr, size_t id);
+// Out-of-range values, infinities, and NaNs are fatal, matching the C backend.
+static void
+push_rvalue_cast_ieee754_to_integer(struct expr const* expr, size_t id);
+// Cast from an integer or IEEE-754 type, rounding to nearest.
+static void
+push_rvalue_cast_to_ieee754(struct expr const* expr, size_t id);
 static void
 push_rvalue_call(struct expr const* expr, size_t id);
+// Lower a call to one of the sys bit manipulation functions to an inline
+// instruction sequence. Returns false if the call is not to such a function.
+static bool
+push_rvalue_call_intrinsic(struct expr const* expr);
 static void
 push_rvalue_access_index(struct expr const* expr, size_t id);
 static void
@@ -958,7 +1083,14 @@ codegen_global_labels(void)
             struct address const* const address = symbol_xget_address(symbol);
             assert(address->kind == ADDRESS_STATIC);
             assert(address->data.static_.offset == 0);
-            appendln("global $%s", address->data.static_.name);
+            // Typed and sized function symbols allow debuggers and sampling
+            // profilers to attribute addresses to functions.
+            appendln(
+                "global $%s:function ($%s%s - $%s)",
+                address->data.static_.name,
+                address->data.static_.name,
+                LABEL_FUNCTION_END,
+                address->data.static_.name);
         }
     }
 }
@@ -1009,6 +1141,110 @@ codegen_static_functions(void)
         }
         codegen_static_function(symbol);
     }
+
+    // Zero terminator marking the end of the unwind information.
+    appendln("section .eh_frame");
+    appendli("dd 0");
+}
+
+static void
+codegen_eh_frame_cie(void)
+{
+    // Common Information Entry shared by the Frame Description Entry of every
+    // function, describing the state at the first instruction of a function,
+    // where the return address is at [rsp] and the CFA is rsp + 8. DWARF
+    // register 6 is rbp, 7 is rsp, and 16 is the return address (rip).
+    // https://refspecs.linuxfoundation.org/LSB_5.0.0/LSB-Core-generic/LSB-Core-generic/ehframechpt.html
+    // clang-format off
+    appendln("section .eh_frame progbits alloc noexec nowrite align=8");
+    appendln("__eh_frame_cie:");
+    appendli("dd __eh_frame_cie_end - __eh_frame_cie_begin ; length");
+    appendln("__eh_frame_cie_begin:");
+    appendli("dd 0 ; CIE id");
+    appendli("db 1 ; version");
+    appendli("db \"zR\", 0 ; augmentation");
+    appendli("db 1 ; code alignment factor");
+    appendli("db 0x78 ; data alignment factor (-8)");
+    appendli("db 16 ; return address register");
+    appendli("db 1 ; augmentation data length");
+    appendli("db 0x1B ; FDE encoding (DW_EH_PE_pcrel | DW_EH_PE_sdata4)");
+    appendli("db 0x0C, 7, 8 ; DW_CFA_def_cfa rsp, 8");
+    appendli("db 0x90, 1 ; DW_CFA_offset rip, cfa - 8");
+    appendli("align 8, db 0 ; DW_CFA_nop");
+    appendln("__eh_frame_cie_end:");
+    // clang-format on
+}
+
+static void
+codegen_eh_frame_fde(struct address const* address)
+{
+    assert(address != NULL);
+    assert(address->kind == ADDRESS_STATIC);
+
+    // Frame Description Entry for a function beginning with the prologue:
+    //      push rbp     ; 1 byte
+    //      mov rbp, rsp ; 3 bytes
+    // after which the CFA is rbp + 16 for the remainder of the function, except
+    // between the `pop rbp` and `ret` of each epilogue, where it is rsp + 8.
+    // clang-format off
+    appendln("section .eh_frame");
+    appendli("dd .__FDE_END - .__FDE_BEGIN ; length");
+    appendln(".__FDE_BEGIN:");
+    appendli("dd $ - __eh_frame_cie ; CIE pointer");
+    appendli("dd $%s - $ ; address", address->data.static_.name);
+    appendli(
+        "dd $%s%s - $%s ; range",
+        address->data.static_.name,
+        LABEL_FUNCTION_END,
+        address->data.static_.name);
+    appendli("db 0 ; augmentation data length");
+    appendli("db 0x41 ; DW_CFA_advance_loc 1");
+    appendli("db 0x0E, 16 ; DW_CFA_def_cfa_offset 16");
+    appendli("db 0x86, 2 ; DW_CFA_offset rbp, cfa - 16");
+    appendli("db 0x43 ; DW_CFA_advance_loc 3");
+    appendli("db 0x0D, 6 ; DW_CFA_def_cfa_register rbp");
+    // Code following an early return is still within the frame, so the state
+    // from before each epilogue is restored after its `ret` (1 byte).
+    char const* location = intern_fmt("$%s + 4", address->data.static_.name);
+    for (size_t i = 0; i < sbuf_count(current_epilogues); ++i) {
+        appendli("db 0x04 ; DW_CFA_advance_loc4");
+        appendli(
+            "dd %s%zu - (%s)",
+            LABEL_EPILOGUE,
+            current_epilogues[i],
+            location);
+        appendli("db 0x0A ; DW_CFA_remember_state");
+        appendli("db 0x0C, 7, 8 ; DW_CFA_def_cfa rsp, 8");
+        appendli("db 0x41 ; DW_CFA_advance_loc 1");
+        appendli("db 0x0B ; DW_CFA_restore_state");
+        location =
+            intern_fmt("%s%zu + 1", LABEL_EPILOGUE, current_epilogues[i]);
+    }
+    appendli("align 8, db 0 ; DW_CFA_nop");
+    appendln(".__FDE_END:");
+    appendln("section .text");
+    // clang-format on
+}
+
+static void
+codegen_epilogue(void)
+{
+    size_t const id = unique_id++;
+    if (profile) {
+        appendli(
+            "lea rdi, [rbp - %#jx] ; profile frame",
+            (uintmax_t)-current_function->local_stack_offset
+                + PROFILE_FRAME_SIZE);
+        appendli("call __profile_leave");
+    }
+    // Restore stack pointer.
+    appendli("mov rsp, rbp");
+    // Restore previous frame pointer.
+    appendli("pop rbp");
+    appendln("%s%zu:", LABEL_EPILOGUE, id);
+    // Return control to the calling routine.
+    appendli("ret");
+    sbuf_push(current_epilogues, id);
 }
 
 static void
@@ -1022,19 +1258,6 @@ codegen_fatals(void)
     // to allow for addresses in the full 64-bit address space.
 
     // clang-format off
-    // Builtin unimplemented handler.
-    appendln("section .text");
-    appendln("__fatal_unimplemented:");
-    appendln("    lea rax, [__fatal_unimplemented_msg_start]");
-    appendln("    push rax");
-    appendln("    push __fatal_unimplemented_msg_count");
-    appendln("    call __fatal");
-    appendch('\n');
-    appendln("section .rodata");
-    appendln("__fatal_unimplemented_msg_start: db \"fatal: unimplemented\", 0x0A");
-    appendln("__fatal_unimplemented_msg_count: equ $ - __fatal_unimplemented_msg_start");
-    appendch('\n');
-
     // Builtin integer divide by zero handler.
     appendln("section .text");
     appendln("__fatal_divide_by_zero:");
@@ -1164,31 +1387,73 @@ codegen_static_function(struct symbol const* symbol)
     // Adjust the stack pointer to make space for locals.
     assert(function->local_stack_offset <= 0);
     uintmax_t stack_size = (uintmax_t)-function->local_stack_offset;
+    if (profile) {
+        stack_size += PROFILE_FRAME_SIZE;
+    }
     appendli("sub rsp, %#jx ; local stack space", stack_size);
     // Zero-initialize local stack objects.
     uintmax_t stack_cur = 0u;
     assert(stack_size % 8 == 0);
     appendli("mov rax, 0");
+    if (stack_size >= COPY_STRING_MIN) {
+        appendli("mov rdi, rsp");
+        appendli("mov rcx, %#jx", stack_size / 8u);
+        appendli("rep stosq");
+        stack_cur = stack_size;
+    }
     while ((stack_size - stack_cur) != 0) {
         appendli("mov [rsp + %#jx], rax", stack_cur);
         stack_cur += 8u;
     }
+    if (profile) {
+        appendli("lea rdi, [rsp] ; profile frame");
+        appendli("lea rsi, [%s]", LABEL_PROFILE_FUNCTION);
+        appendli("call __profile_enter");
+    }
 
     assert(current_function == NULL);
     current_function = function;
     codegen_block(&function->body);
-    current_function = NULL;
 
     if (function->type->data.function.return_type == context()->builtin.void_) {
         appendli("; EPILOGUE (implicit-return)");
-        appendli("mov rsp, rbp");
-        appendli("pop rbp");
-        appendli("ret");
+        codegen_epilogue();
     }
+    current_function = NULL;
     appendli("; END-OF-FUNCTION");
+    appendln("%s:", LABEL_FUNCTION_END);
+    codegen_eh_frame_fde(address);
+    sbuf_resize(current_epilogues, 0);
+    if (profile) {
+        codegen_profile_function(function);
+    }
     appendch('\n');
 }
 
+static void
+codegen_profile_function(struct function const* function)
+{
+    assert(function != NULL);
+
+    // Profile record of the function, with the layout expected by the builtin
+    // profiler subroutines of sys.asm. The fields following the name are
+    // updated at runtime.
+    appendln("section .data");
+    appendln("align 8");
+    appendln("%s:", LABEL_PROFILE_FUNCTION);
+    appendli("dq %s ; name_start", LABEL_PROFILE_NAME);
+    appendli("dq %zu ; name_count", strlen(function->name));
+    appendli("dq 0 ; id");
+    appendli("dq 0 ; calls");
+    appendli("dq 0 ; inclusive_ns");
+    appendli("dq 0 ; self_ns");
+    appendli("dq 0 ; active");
+    appendli("dq 0 ; next");
+    appendln("section .rodata");
+    appendln("%s: db \"%s\"", LABEL_PROFILE_NAME, function->name);
+    appendln("section .text");
+}
+
 static void
 codegen_block(struct block const* block)
 {
@@ -1421,12 +1686,7 @@ codegen_stmt_return(struct stmt const* stmt, size_t id)
     codegen_defers(stmt->data.return_.defer, NULL);
 
     appendli("; STMT_RETURN EPILOGUE");
-    // Restore stack pointer.
-    appendli("mov rsp, rbp");
-    // Restore previous frame pointer.
-    appendli("pop rbp");
-    // Return control to the calling routine.
-    appendli("ret");
+    codegen_epilogue();
 }
 
 static void
@@ -1862,12 +2122,15 @@ push_rvalue_cast(struct expr const* expr, size_t id)
     assert(expr->kind == EXPR_CAST);
     assert(expr->type->size >= 1u);
     assert(expr->type->size <= 8u);
-    (void)id;
 
     if (type_is_integer(expr->type)
         && type_is_ieee754(expr->data.cast.expr->type)) {
-        push_rvalue(expr->data.cast.expr);
-        appendli("call __fatal_unimplemented");
+        push_rvalue_cast_ieee754_to_integer(expr, id);
+        return;
+    }
+
+    if (type_is_ieee754(expr->type)) {
+        push_rvalue_cast_to_ieee754(expr, id);
         return;
     }
 
@@ -1892,6 +2155,125 @@ push_rvalue_cast(struct expr const* expr, size_t id)
     appendli("mov [rsp], rax");
 }
 
+static void
+push_rvalue_cast_ieee754_to_integer(struct expr const* expr, size_t id)
+{
+    assert(expr != NULL);
+    assert(expr->kind == EXPR_CAST);
+    assert(type_is_integer(expr->type));
+    assert(type_is_ieee754(expr->data.cast.expr->type));
+
+    struct type const* const from = expr->data.cast.expr->type;
+    struct type const* const to = expr->type;
+    char const* const sfx = sse_suffix(from);
+
+    // Bounds of the integer type rounded toward zero to the precision of the
+    // IEEE-754 type, so that both bounds are themselves in range.
+    unsigned const value_bits =
+        (unsigned)to->size * 8u - (type_is_sinteger(to) ? 1u : 0u);
+    unsigned const significand_bits = from->kind == TYPE_F32 ? 24u : 53u;
+    double pow2 = 1.0; // 2^value_bits
+    double ulp = 1.0; // 2^max(value_bits - significand_bits, 0)
+    for (unsigned i = 0; i < value_bits; ++i) {
+        pow2 *= 2.0;
+        ulp *= i >= significand_bits ? 2.0 : 1.0;
+    }
+    double const min = type_is_sinteger(to) ? -pow2 : 0.0;
+    double const max = pow2 - ulp;
+
+    push_rvalue(expr->data.cast.expr);
+    appendli("pop rax");
+    appendli(
+        "%s xmm0, %s",
+        from->kind == TYPE_F32 ? "movd" : "movq",
+        reg_a(from->size));
+
+    // The comparison with the lower bound is unordered for NaN, which sets CF.
+    mov_xmm_ieee754("xmm1", from, min);
+    appendli("ucomi%s xmm0, xmm1", sfx);
+    appendli("jb %s%zu_out_of_range", LABEL_EXPR, id);
+    mov_xmm_ieee754("xmm1", from, max);
+    appendli("ucomi%s xmm0, xmm1", sfx);
+    appendli("jbe %s%zu_in_range", LABEL_EXPR, id);
+    appendln("%s%zu_out_of_range:", LABEL_EXPR, id);
+    appendli("call __fatal_out_of_range");
+    appendln("%s%zu_in_range:", LABEL_EXPR, id);
+
+    if (to->size < 8u || type_is_sinteger(to)) {
+        appendli("cvtt%s2si rax, xmm0", sfx);
+        appendli("push rax");
+        return;
+    }
+
+    // CVTTSD2SI and CVTTSS2SI produce signed integers, so values of 2^63 and
+    // above are converted with 2^63 subtracted and the top bit set afterwards.
+    mov_xmm_ieee754("xmm1", from, pow2 / 2.0);
+    appendli("ucomi%s xmm0, xmm1", sfx);
+    appendli("jb %s%zu_convert", LABEL_EXPR, id);
+    appendli("sub%s xmm0, xmm1", sfx);
+    appendli("cvtt%s2si rax, xmm0", sfx);
+    appendli("btc rax, 63");
+    appendli("jmp %s%zu_end", LABEL_EXPR, id);
+    appendln("%s%zu_convert:", LABEL_EXPR, id);
+    appendli("cvtt%s2si rax, xmm0", sfx);
+    appendln("%s%zu_end:", LABEL_EXPR, id);
+    appendli("push rax");
+}
+
+static void
+push_rvalue_cast_to_ieee754(struct expr const* expr, size_t id)
+{
+    assert(expr != NULL);
+    assert(expr->kind == EXPR_CAST);
+    assert(type_is_ieee754(expr->type));
+
+    struct type const* const from = expr->data.cast.expr->type;
+    struct type const* const to = expr->type;
+    char const* const sfx = sse_suffix(to);
+
+    push_rvalue(expr->data.cast.expr);
+    if (from->kind == to->kind) {
+        return;
+    }
+
+    appendli("pop rax");
+    if (type_is_ieee754(from)) {
+        appendli(
+            "%s xmm0, %s",
+            from->kind == TYPE_F32 ? "movd" : "movq",
+            reg_a(from->size));
+        appendli("cvt%s2%s xmm0, xmm0", sse_suffix(from), sfx);
+        push_xmm0_ieee754(to);
+        return;
+    }
+
+    assert(type_is_integer(from));
+    mov_rax_reg_a_with_zero_or_sign_extend(from);
+    if (from->size < 8u || type_is_sinteger(from)) {
+        appendli("cvtsi2%s xmm0, rax", sfx);
+        push_xmm0_ieee754(to);
+        return;
+    }
+
+    // CVTSI2SD and CVTSI2SS convert signed integers, so values of 2^63 and
+    // above are halved before conversion and doubled after. The discarded
+    // low bit is ORed back into the halved value so that it still takes part
+    // in rounding.
+    appendli("test rax, rax");
+    appendli("js %s%zu_halve", LABEL_EXPR, id);
+    appendli("cvtsi2%s xmm0, rax", sfx);
+    appendli("jmp %s%zu_end", LABEL_EXPR, id);
+    appendln("%s%zu_halve:", LABEL_EXPR, id);
+    appendli("mov rbx, rax");
+    appendli("shr rbx, 1");
+    appendli("and rax, 1");
+    appendli("or rbx, rax");
+    appendli("cvtsi2%s xmm0, rbx", sfx);
+    appendli("add%s xmm0, xmm0", sfx);
+    appendln("%s%zu_end:", LABEL_EXPR, id);
+    push_xmm0_ieee754(to);
+}
+
 static void
 push_rvalue_call(struct expr const* expr, size_t id)
 {
@@ -1899,6 +2281,10 @@ push_rvalue_call(struct expr const* expr, size_t id)
     assert(expr->kind == EXPR_CALL);
     (void)id;
 
+    if (push_rvalue_call_intrinsic(expr)) {
+        return;
+    }
+
     // Push space for return value.
     struct type const* function_type = expr->data.call.function->type;
     assert(function_type->kind == TYPE_FUNCTION);
@@ -1932,6 +2318,137 @@ push_rvalue_call(struct expr const* expr, size_t id)
     }
 }
 
+// The sys bit manipulation functions, and the instructions each is lowered
+// to. Every argument and result of these functions occupies exactly one
+// 8-byte stack slot, so after the arguments are pushed the instructions pop
+// all but the first argument and overwrite the first argument with the
+// result, leaving the stack in the same state as a call would.
+//
+// The bsr and bsf instructions leave their destination undefined when the
+// source is zero, so the zero case is handled with a cmov. The lzcnt and
+// tzcnt instructions are not used since they silently execute as bsr and bsf
+// on processors without support for them. The popcnt instruction is not part
+// of the baseline x86-64 instruction set either, so bits are counted in
+// parallel within rax instead.
+static struct {
+    char const* name;
+    char const* instructions[24]; // NULL terminated.
+} const intrinsics[] = {
+#define INTRINSIC_COUNT_ONES(name, load)                                       \
+    {(name),                                                                   \
+     {load,                                                                    \
+      "mov rcx, rax",                                                          \
+      "shr rcx, 1",                                                            \
+      "mov rbx, 0x5555555555555555",                                           \
+      "and rcx, rbx",                                                          \
+      "sub rax, rcx",                                                          \
+      "mov rcx, rax",                                                          \
+      "shr rcx, 2",                                                            \
+      "mov rbx, 0x3333333333333333",                                           \
+      "and rax, rbx",                                                          \
+      "and rcx, rbx",                                                          \
+      "add rax, rcx",                                                          \
+      "mov rcx, rax",                                                          \
+      "shr rcx, 4",                                                            \
+      "add rax, rcx",                                                          \
+      "mov rbx, 0x0F0F0F0F0F0F0F0F",                                           \
+      "and rax, rbx",                                                          \
+      "mov rbx, 0x0101010101010101",                                           \
+      "imul rax, rbx",                                                         \
+      "shr rax, 56",                                                           \
+      "mov [rsp], rax",                                                        \
+      NULL}}
+#define INTRINSIC_ROTATE(name, reg, instr)                                     \
+    {(name),                                                                   \
+     {"pop rcx",                                                               \
+      "mov " reg ", [rsp]",                                                    \
+      instr " " reg ", cl",                                                    \
+      "mov [rsp], " reg,                                                       \
+      NULL}}
+    INTRINSIC_COUNT_ONES("sys.u32_count_ones", "mov eax, dword [rsp]"),
+    INTRINSIC_COUNT_ONES("sys.u64_count_ones", "mov rax, qword [rsp]"),
+    {"sys.u32_leading_zeros",
+     {"mov ebx, -1",
+      "bsr eax, dword [rsp]",
+      "cmovz eax, ebx",
+      "neg eax",
+      "add eax, 31",
+      "mov [rsp], rax",
+      NULL}},
+    {"sys.u64_leading_zeros",
+     {"mov rbx, -1",
+      "bsr rax, qword [rsp]",
+      "cmovz rax, rbx",
+      "neg rax",
+      "add rax, 63",
+      "mov [rsp], rax",
+      NULL}},
+    {"sys.u32_trailing_zeros",
+     {"mov ebx, 32",
+      "bsf eax, dword [rsp]",
+      "cmovz eax, ebx",
+      "mov [rsp], rax",
+      NULL}},
+    {"sys.u64_trailing_zeros",
+     {"mov rbx, 64",
+      "bsf rax, qword [rsp]",
+      "cmovz rax, rbx",
+      "mov [rsp], rax",
+      NULL}},
+    {"sys.u16_byte_swap",
+     {"mov ax, [rsp]", "rol ax, 8", "mov [rsp], ax", NULL}},
+    {"sys.u32_byte_swap",
+     {"mov eax, [rsp]", "bswap eax", "mov [rsp], eax", NULL}},
+    {"sys.u64_byte_swap",
+     {"mov rax, [rsp]", "bswap rax", "mov [rsp], rax", NULL}},
+    INTRINSIC_ROTATE("sys.u8_rotate_left", "al", "rol"),
+    INTRINSIC_ROTATE("sys.u16_rotate_left", "ax", "rol"),
+    INTRINSIC_ROTATE("sys.u32_rotate_left", "eax", "rol"),
+    INTRINSIC_ROTATE("sys.u64_rotate_left", "rax", "rol"),
+    INTRINSIC_ROTATE("sys.u8_rotate_right", "al", "ror"),
+    INTRINSIC_ROTATE("sys.u16_rotate_right", "ax", "ror"),
+    INTRINSIC_ROTATE("sys.u32_rotate_right", "eax", "ror"),
+    INTRINSIC_ROTATE("sys.u64_rotate_right", "rax", "ror"),
+#undef INTRINSIC_ROTATE
+#undef INTRINSIC_COUNT_ONES
+};
+
+static bool
+push_rvalue_call_intrinsic(struct expr const* expr)
+{
+    assert(expr != NULL);
+    assert(expr->kind == EXPR_CALL);
+
+    struct expr const* const function = expr->data.call.function;
+    if (function->kind != EXPR_SYMBOL
+        || function->data.symbol->kind != SYMBOL_FUNCTION) {
+        return false;
+    }
+    struct address const* const address =
+        symbol_xget_address(function->data.symbol);
+    assert(address->kind == ADDRESS_STATIC);
+
+    for (size_t i = 0; i < ARRAY_COUNT(intrinsics); ++i) {
+        if (0 != strcmp(address->data.static_.name, intrinsics[i].name)) {
+            continue;
+        }
+
+        struct expr const* const* const arguments = expr->data.call.arguments;
+        for (size_t j = 0; j < sbuf_count(arguments); ++j) {
+            assert(arguments[j]->type->size <= 8u);
+            push_rvalue(arguments[j]);
+        }
+        appendli("; inline %s", intrinsics[i].name);
+        for (char const* const* instr = intrinsics[i].instructions; *instr;
+             ++instr) {
+            appendli("%s", *instr);
+        }
+        return true;
+    }
+
+    return false;
+}
+
 static void
 push_rvalue_access_index(struct expr const* expr, size_t id)
 {
@@ -2345,7 +2862,12 @@ push_rvalue_unary_neg(struct expr const* expr, size_t id)
 
     if (type_is_ieee754(rhs->type)) {
         push_rvalue(expr->data.unary.rhs);
-        appendli("call __fatal_unimplemented");
+        appendli("pop rax");
+        appendli(
+            "btc %s, %ju ; flip the sign bit",
+            reg_a(rhs->type->size),
+            rhs->type->size * 8u - 1u);
+        appendli("push rax");
         return;
     }
 
@@ -2744,7 +3266,16 @@ push_rvalue_binary_eq(struct expr const* expr, size_t id)
 
     struct type const* const xhs_type = expr->data.binary.lhs->type;
     if (type_is_ieee754(xhs_type)) {
-        appendli("call __fatal_unimplemented");
+        pop_xmm0_xmm1_ieee754(xhs_type);
+        // Unordered operands (NaN) set ZF and PF, so equality requires ZF set
+        // and PF clear.
+        appendli("mov rcx, 0"); // result (default false)
+        appendli("mov rdx, 0");
+        appendli("ucomi%s xmm0, xmm1", sse_suffix(xhs_type));
+        appendli("sete cl");
+        appendli("setnp dl");
+        appendli("and rcx, rdx");
+        appendli("push rcx");
         return;
     }
 
@@ -2777,7 +3308,14 @@ push_rvalue_binary_ne(struct expr const* expr, size_t id)
 
     struct type const* const xhs_type = expr->data.binary.lhs->type;
     if (type_is_ieee754(xhs_type)) {
-        appendli("call __fatal_unimplemented");
+        pop_xmm0_xmm1_ieee754(xhs_type);
+        appendli("mov rcx, 0"); // result (default false)
+        appendli("mov rdx, 0");
+        appendli("ucomi%s xmm0, xmm1", sse_suffix(xhs_type));
+        appendli("setne cl");
+        appendli("setp dl");
+        appendli("or rcx, rdx");
+        appendli("push rcx");
         return;
     }
 
@@ -2811,7 +3349,13 @@ push_rvalue_binary_le(struct expr const* expr, size_t id)
     push_rvalue(expr->data.binary.rhs);
 
     if (type_is_ieee754(xhs_type)) {
-        appendli("call __fatal_unimplemented");
+        pop_xmm0_xmm1_ieee754(xhs_type);
+        // Unordered operands (NaN) set CF, so the operands are compared in
+        // reverse order to test with the "above" condition codes.
+        appendli("mov rcx, 0"); // result (default false)
+        appendli("ucomi%s xmm1, xmm0", sse_suffix(xhs_type));
+        appendli("setae cl");
+        appendli("push rcx");
         return;
     }
 
@@ -2845,7 +3389,13 @@ push_rvalue_binary_lt(struct expr const* expr, size_t id)
     push_rvalue(expr->data.binary.rhs);
 
     if (type_is_ieee754(xhs_type)) {
-        appendli("call __fatal_unimplemented");
+        pop_xmm0_xmm1_ieee754(xhs_type);
+        // Unordered operands (NaN) set CF, so the operands are compared in
+        // reverse order to test with the "above" condition codes.
+        appendli("mov rcx, 0"); // result (default false)
+        appendli("ucomi%s xmm1, xmm0", sse_suffix(xhs_type));
+        appendli("seta cl");
+        appendli("push rcx");
         return;
     }
 
@@ -2879,7 +3429,11 @@ push_rvalue_binary_ge(struct expr const* expr, size_t id)
     push_rvalue(expr->data.binary.rhs);
 
     if (type_is_ieee754(xhs_type)) {
-        appendli("call __fatal_unimplemented");
+        pop_xmm0_xmm1_ieee754(xhs_type);
+        appendli("mov rcx, 0"); // result (default false)
+        appendli("ucomi%s xmm0, xmm1", sse_suffix(xhs_type));
+        appendli("setae cl");
+        appendli("push rcx");
         return;
     }
 
@@ -2913,7 +3467,11 @@ push_rvalue_binary_gt(struct expr const* expr, size_t id)
     push_rvalue(expr->data.binary.rhs);
 
     if (type_is_ieee754(xhs_type)) {
-        appendli("call __fatal_unimplemented");
+        pop_xmm0_xmm1_ieee754(xhs_type);
+        appendli("mov rcx, 0"); // result (default false)
+        appendli("ucomi%s xmm0, xmm1", sse_suffix(xhs_type));
+        appendli("seta cl");
+        appendli("push rcx");
         return;
     }
 
@@ -2944,7 +3502,9 @@ push_rvalue_binary_add(struct expr const* expr, size_t id)
     if (type_is_ieee754(xhs_type)) {
         push_rvalue(expr->data.binary.lhs);
         push_rvalue(expr->data.binary.rhs);
-        appendli("call __fatal_unimplemented");
+        pop_xmm0_xmm1_ieee754(xhs_type);
+        appendli("add%s xmm0, xmm1", sse_suffix(xhs_type));
+        push_xmm0_ieee754(xhs_type);
         return;
     }
 
@@ -3010,7 +3570,9 @@ push_rvalue_binary_sub(struct expr const* expr, size_t id)
     if (type_is_ieee754(xhs_type)) {
         push_rvalue(expr->data.binary.lhs);
         push_rvalue(expr->data.binary.rhs);
-        appendli("call __fatal_unimplemented");
+        pop_xmm0_xmm1_ieee754(xhs_type);
+        appendli("sub%s xmm0, xmm1", sse_suffix(xhs_type));
+        push_xmm0_ieee754(xhs_type);
         return;
     }
 
@@ -3076,7 +3638,9 @@ push_rvalue_binary_mul(struct expr const* expr, size_t id)
     if (type_is_ieee754(xhs_type)) {
         push_rvalue(expr->data.binary.lhs);
         push_rvalue(expr->data.binary.rhs);
-        appendli("call __fatal_unimplemented");
+        pop_xmm0_xmm1_ieee754(xhs_type);
+        appendli("mul%s xmm0, xmm1", sse_suffix(xhs_type));
+        push_xmm0_ieee754(xhs_type);
         return;
     }
 
@@ -3138,9 +3702,12 @@ push_rvalue_binary_divrem(struct expr const* expr, size_t id)
 
     struct type const* const xhs_type = expr->data.binary.lhs->type;
     if (type_is_ieee754(xhs_type)) {
+        assert(expr->data.binary.op == BOP_DIV);
         push_rvalue(expr->data.binary.lhs);
         push_rvalue(expr->data.binary.rhs);
-        appendli("call __fatal_unimplemented");
+        pop_xmm0_xmm1_ieee754(xhs_type);
+        appendli("div%s xmm0, xmm1", sse_suffix(xhs_type));
+        push_xmm0_ieee754(xhs_type);
         return;
     }
 
@@ -3468,11 +4035,28 @@ push_lvalue_unary(struct expr const* expr, size_t id)
     UNREACHABLE();
 }
 
+static char const*
+function_symbol_name(struct symbol const* symbol)
+{
+    assert(symbol != NULL);
+    assert(symbol->kind == SYMBOL_FUNCTION);
+
+    return symbol_xget_address(symbol)->data.static_.name;
+}
+
 void
 codegen_nasm(
     bool opt_c,
+    bool opt_flto,
+    bool opt_fprofile_generate,
+    char const* opt_fprofile_use,
+    bool opt_fno_bounds_checks,
+    bool opt_fno_overflow_checks,
     bool opt_g,
     bool opt_k,
+    bool opt_m,
+    bool opt_p,
+    bool opt_s,
     char const* const* opt_L,
     char const* const* opt_l,
     char const* const opt_o)
@@ -3483,8 +4067,28 @@ codegen_nasm(
     bool const is_nasm = cstr_eq_ignore_case(backend, "nasm");
     bool const is_yasm = cstr_eq_ignore_case(backend, "yasm");
     assert(is_nasm || is_yasm);
+    (void)opt_s; // Line directives are only emitted by the C backend.
+    if (opt_flto) {
+        fatal(
+            NO_LOCATION,
+            "link-time optimization is not supported by the %s backend",
+            backend);
+    }
+    if (opt_fprofile_generate || opt_fprofile_use != NULL) {
+        fatal(
+            NO_LOCATION,
+            "profile-guided optimization is not supported by the %s backend",
+            backend);
+    }
+    if (opt_fno_bounds_checks || opt_fno_overflow_checks) {
+        fatal(
+            NO_LOCATION,
+            "disabling safety checks is not supported by the %s backend",
+            backend);
+    }
 
     debug = opt_g;
+    profile = opt_p;
     out = string_new(NULL, 0u);
     struct string* const asm_path = string_new_fmt("%s.tmp.asm", opt_o);
     struct string* const obj_path = string_new_fmt("%s.tmp.o", opt_o);
@@ -3531,6 +4135,7 @@ codegen_nasm(
 
     sbuf(char const*) ld_argv = NULL;
     sbuf_push(ld_argv, "ld");
+    sbuf_push(ld_argv, "--eh-frame-hdr");
     sbuf_push(ld_argv, "-o");
     sbuf_push(ld_argv, opt_o);
     sbuf_push(ld_argv, string_start(obj_path));
@@ -3538,7 +4143,11 @@ codegen_nasm(
         sbuf_push(ld_argv, intern_fmt("-L%s", opt_L[i]));
     }
     for (size_t i = 0; i < sbuf_count(opt_l); ++i) {
-        sbuf_push(ld_argv, opt_l[i]);
+        if (is_raw_linker_argument(opt_l[i])) {
+            sbuf_push(ld_argv, opt_l[i]);
+            continue;
+        }
+        sbuf_push(ld_argv, intern_fmt("-l%s", opt_l[i]));
     }
     sbuf_push(ld_argv, (char const*)NULL);
 
@@ -3556,6 +4165,14 @@ codegen_nasm(
         appendln("%%define __entry");
         appendch('\n');
     }
+    if (opt_p) {
+        appendln("%%define __profile");
+        appendch('\n');
+    }
+    // The CIE precedes sys.asm so that sys.asm routines are able to describe
+    // their own frames in the .eh_frame section.
+    codegen_eh_frame_cie();
+    appendch('\n');
     append("%.*s", (int)sysasm_buf_size, (char const*)sysasm_buf);
     appendch('\n');
     codegen_fatals();
@@ -3577,12 +4194,19 @@ codegen_nasm(
         goto cleanup;
     }
 
-    if ((err = spawnvpw(backend_argv))) {
+    enum phase const suspended = phase_enter(PHASE_BACKEND);
+    err = spawnvpw(backend_argv);
+    if (!err && !opt_c) {
+        err = spawnvpw(ld_argv);
+    }
+    phase_leave(suspended);
+    if (err) {
         goto cleanup;
     }
 
-    if (!opt_c && (err = spawnvpw(ld_argv))) {
-        goto cleanup;
+    if (opt_m && !opt_c) {
+        err = write_perf_map(
+            opt_o, intern_fmt("%s.map", opt_o), function_symbol_name);
     }
 
 cleanup:
@@ -3595,6 +4219,7 @@ cleanup:
     xalloc(sysasm_buf, XALLOC_FREE);
     sbuf_fini(backend_argv);
     sbuf_fini(ld_argv);
+    sbuf_fini(current_epilogues);
     string_del(asm_path);
     string_del(obj_path);
     string_del(out);
@@ -1,5 +1,8 @@
 // SPDX-License-Identifier: Apache-2.0
 #include <assert.h>
+#include <elf.h>
+#include <errno.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
 #include "sunder.h"
@@ -7,8 +10,16 @@
 void
 codegen(
     bool opt_c,
+    bool opt_flto,
+    bool opt_fprofile_generate,
+    char const* opt_fprofile_use,
+    bool opt_fno_bounds_checks,
+    bool opt_fno_overflow_checks,
     bool opt_g,
     bool opt_k,
+    bool opt_m,
+    bool opt_p,
+    bool opt_s,
     char const* const* opt_L,
     char const* const* opt_l,
     char const* const opt_o)
@@ -17,15 +28,163 @@ codegen(
 
     char const* const backend = context()->env.SUNDER_BACKEND;
     if (cstr_eq_ignore_case(backend, "C")) {
-        codegen_c(opt_c, opt_g, opt_k, opt_L, opt_l, opt_o);
+        enum phase const suspended = phase_enter(PHASE_CODEGEN);
+        codegen_c(
+            opt_c,
+            opt_flto,
+            opt_fprofile_generate,
+            opt_fprofile_use,
+            opt_fno_bounds_checks,
+            opt_fno_overflow_checks,
+            opt_g,
+            opt_k,
+            opt_m,
+            opt_p,
+            opt_s,
+            opt_L,
+            opt_l,
+            opt_o);
+        phase_leave(suspended);
         return;
     }
 
     if (cstr_eq_ignore_case(backend, "nasm")
         || cstr_eq_ignore_case(backend, "yasm")) {
-        codegen_nasm(opt_c, opt_g, opt_k, opt_L, opt_l, opt_o);
+        enum phase const suspended = phase_enter(PHASE_CODEGEN);
+        codegen_nasm(
+            opt_c,
+            opt_flto,
+            opt_fprofile_generate,
+            opt_fprofile_use,
+            opt_fno_bounds_checks,
+            opt_fno_overflow_checks,
+            opt_g,
+            opt_k,
+            opt_m,
+            opt_p,
+            opt_s,
+            opt_L,
+            opt_l,
+            opt_o);
+        phase_leave(suspended);
         return;
     }
 
     fatal(NO_LOCATION, "unrecognized backend `%s`", backend);
 }
+
+bool
+is_raw_linker_argument(char const* opt)
+{
+    assert(opt != NULL);
+
+    return opt[0] == '-' || strchr(opt, '/') != NULL
+        || strstr(opt, ".so.") != NULL || cstr_ends_with(opt, ".o")
+        || cstr_ends_with(opt, ".a") || cstr_ends_with(opt, ".so");
+}
+
+int
+write_perf_map(
+    char const* exe_path,
+    char const* map_path,
+    char const* (*symbol_name)(struct symbol const* symbol))
+{
+    assert(exe_path != NULL);
+    assert(map_path != NULL);
+    assert(symbol_name != NULL);
+
+    void* buf = NULL;
+    size_t buf_size = 0;
+    if (file_read_all(exe_path, &buf, &buf_size)) {
+        error(
+            NO_LOCATION,
+            "unable to read file `%s` with error '%s'",
+            exe_path,
+            strerror(errno));
+        return -1;
+    }
+    unsigned char const* const bytes = buf;
+
+    // Locate the symbol table and its associated string table.
+    Elf64_Ehdr ehdr = {0};
+    Elf64_Shdr symtab = {0};
+    Elf64_Shdr strtab = {0};
+    bool found = false;
+    if (buf_size >= sizeof(ehdr)) {
+        memcpy(&ehdr, bytes, sizeof(ehdr));
+    }
+    bool const is_elf64 = buf_size >= sizeof(ehdr)
+        && memcmp(ehdr.e_ident, ELFMAG, SELFMAG) == 0
+        && ehdr.e_ident[EI_CLASS] == ELFCLASS64
+        && ehdr.e_shentsize == sizeof(Elf64_Shdr)
+        && ehdr.e_shoff <= buf_size
+        && (buf_size - ehdr.e_shoff) / sizeof(Elf64_Shdr) >= ehdr.e_shnum;
+    for (size_t i = 0; is_elf64 && i < ehdr.e_shnum; ++i) {
+        memcpy(
+            &symtab,
+            bytes + ehdr.e_shoff + i * sizeof(Elf64_Shdr),
+            sizeof(symtab));
+        if (symtab.sh_type != SHT_SYMTAB || symtab.sh_link >= ehdr.e_shnum) {
+            continue;
+        }
+        memcpy(
+            &strtab,
+            bytes + ehdr.e_shoff + symtab.sh_link * sizeof(Elf64_Shdr),
+            sizeof(strtab));
+        found = symtab.sh_offset <= buf_size
+            && buf_size - symtab.sh_offset >= symtab.sh_size
+            && strtab.sh_offset <= buf_size
+            && buf_size - strtab.sh_offset >= strtab.sh_size
+            && strtab.sh_size != 0
+            && bytes[strtab.sh_offset + strtab.sh_size - 1] == '\0';
+        break;
+    }
+    if (!found) {
+        error(NO_LOCATION, "unable to find symbol table of `%s`", exe_path);
+        xalloc(buf, XALLOC_FREE);
+        return -1;
+    }
+
+    struct string* const map = string_new(NULL, 0u);
+    for (size_t i = 0; i < symtab.sh_size / sizeof(Elf64_Sym); ++i) {
+        Elf64_Sym sym = {0};
+        memcpy(
+            &sym,
+            bytes + symtab.sh_offset + i * sizeof(Elf64_Sym),
+            sizeof(sym));
+        if (ELF64_ST_TYPE(sym.st_info) != STT_FUNC || sym.st_size == 0
+            || sym.st_name >= strtab.sh_size) {
+            continue;
+        }
+
+        char const* const name = intern_cstr(
+            (char const*)bytes + strtab.sh_offset + sym.st_name);
+        for (size_t j = 0; j < sbuf_count(context()->static_symbols); ++j) {
+            struct symbol const* const symbol = context()->static_symbols[j];
+            if (symbol->kind != SYMBOL_FUNCTION || symbol_name(symbol) != name) {
+                continue;
+            }
+            string_append_fmt(
+                map,
+                "%" PRIx64 " %" PRIx64 " %s\n",
+                (uint64_t)sym.st_value,
+                (uint64_t)sym.st_size,
+                symbol->data.function->name);
+            break;
+        }
+    }
+
+    int const err =
+        file_write_all(map_path, string_start(map), string_count(map));
+    if (err) {
+        error(
+            NO_LOCATION,
+            "unable to write file `%s` with error '%s'",
+            map_path,
+            strerror(errno));
+    }
+
+    string_del(map);
+    xalloc(buf, XALLOC_FREE);
+    return err;
+}
@@ -130,7 +130,6 @@ token_to_new_cstr(struct token token)
 struct lexer {
     struct module* module;
     char const* current;
-    size_t current_line;
 };
 
 struct lexer*
@@ -143,7 +142,6 @@ lexer_new(struct module* module)
 
     self->module = module;
     self->current = module->source;
-    self->current_line = 1;
 
     return self;
 }
@@ -157,6 +155,17 @@ lexer_del(struct lexer* self)
     xalloc(self, XALLOC_FREE);
 }
 
+// Returns the location of the character at ptr within the module source.
+static struct source_location
+lexer_location(struct lexer const* self, char const* ptr)
+{
+    assert(self != NULL);
+    assert(ptr >= self->module->source);
+
+    return source_location_offset(
+        self->module->location, (size_t)(ptr - self->module->source));
+}
+
 static struct token
 token_init(
     char const* start,
@@ -245,7 +254,6 @@ skip_whitespace(struct lexer* self)
     assert(self != NULL);
 
     while (safe_isspace(*self->current)) {
-        self->current_line += *self->current == '\n';
         self->current += 1;
     }
 }
@@ -262,8 +270,11 @@ skip_comment(struct lexer* self)
     while (*self->current != '\0' && *self->current != '\n') {
         self->current += 1;
     }
-    self->current += STR_LITERAL_COUNT("\n");
-    self->current_line += 1;
+    // A comment on the last line of a source without a trailing newline is
+    // terminated by the NUL-terminator, which must not be skipped.
+    if (*self->current == '\n') {
+        self->current += STR_LITERAL_COUNT("\n");
+    }
 }
 
 static void
@@ -324,8 +335,8 @@ lex_number(struct lexer* self, struct source_location location)
 
     // Digits
     if (!radix_isdigit(*self->current)) {
-        struct source_location const location = {
-            self->module->name, self->current_line, self->current};
+        struct source_location const location =
+            lexer_location(self, self->current);
         fatal(location, "integer literal has no digits");
     }
     while (radix_isdigit(*self->current)) {
@@ -384,13 +395,13 @@ advance_character(struct lexer* self, char const* what)
 
     // Check for invalid characters.
     if (*self->current == '\n') {
-        struct source_location const location = {
-            self->module->name, self->current_line, self->current};
+        struct source_location const location =
+            lexer_location(self, self->current);
         fatal(location, "end-of-line encountered in %s", what);
     }
     if (!safe_isprint(*self->current)) {
-        struct source_location const location = {
-            self->module->name, self->current_line, self->current};
+        struct source_location const location =
+            lexer_location(self, self->current);
         fatal(
             location,
             "non-printable byte 0x%02x in %s",
@@ -432,8 +443,8 @@ advance_character(struct lexer* self, char const* what)
     case 'x': {
         if (!safe_isxdigit(self->current[2])
             || !safe_isxdigit(self->current[3])) {
-            struct source_location const location = {
-                self->module->name, self->current_line, self->current};
+            struct source_location const location =
+                lexer_location(self, self->current);
             fatal(location, "invalid hexadecimal escape sequence");
         }
         int const result =
@@ -443,8 +454,8 @@ advance_character(struct lexer* self, char const* what)
         return result;
     }
     default: {
-        struct source_location const location = {
-            self->module->name, self->current_line, self->current};
+        struct source_location const location =
+            lexer_location(self, self->current);
         fatal(location, "unknown escape sequence");
     }
     }
@@ -480,14 +491,14 @@ lex_character(struct lexer* self, struct source_location location)
     //                 |+- This character is checked by advance_character.
     //                 +- Lexing starts here.
     if (*self->current == '\n') {
-        struct source_location const location = {
-            self->module->name, self->current_line, self->current};
+        struct source_location const location =
+            lexer_location(self, self->current);
         fatal(location, "end-of-line encountered in character literal");
     }
 
     if (*self->current != '\'') {
-        struct source_location const location = {
-            self->module->name, self->current_line, start};
+        struct source_location const location =
+            lexer_location(self, start);
         fatal(location, "invalid character literal");
     }
     self->current += 1;
@@ -557,11 +568,8 @@ lexer_next_token(struct lexer* self)
     assert(self != NULL);
 
     skip_whitespace_and_comments(self);
-    struct source_location const location = (struct source_location){
-        self->module->name,
-        self->current_line,
-        self->current,
-    };
+    struct source_location const location =
+        lexer_location(self, self->current);
 
     char const ch = *self->current;
     if (safe_isalpha(ch) || ch == '_') {
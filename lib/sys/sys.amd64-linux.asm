@@ -26,6 +26,44 @@ __PROT_WRITE equ 0x2
 __MAP_PRIVATE   equ 0x02
 __MAP_ANONYMOUS equ 0x20
 
+__ROUND_FLOOR equ 0x9 ; round down, suppress precision exception
+__ROUND_CEIL  equ 0xA ; round up, suppress precision exception
+__ROUND_TRUNC equ 0xB ; round toward zero, suppress precision exception
+
+; UNWIND INFORMATION
+; ==================
+; Frame Description Entry in the .eh_frame section for the subroutine at %1,
+; placed directly after the subroutine. The subroutine must begin with the
+; prologue:
+;     push rbp     ; 1 byte
+;     mov rbp, rsp ; 3 bytes
+; and end with the epilogue:
+;     mov rsp, rbp
+;     pop rbp
+;     ret          ; 1 byte
+; The Common Information Entry at __eh_frame_cie is emitted by the compiler.
+%macro __SYS_EH_FRAME_FDE 1
+%%end:
+section .eh_frame
+    dd %%fde_end - %%fde_begin ; length
+%%fde_begin:
+    dd $ - __eh_frame_cie ; CIE pointer
+    dd %1 - $ ; address
+    dd %%end - %1 ; range
+    db 0 ; augmentation data length
+    db 0x41 ; DW_CFA_advance_loc 1
+    db 0x0E, 16 ; DW_CFA_def_cfa_offset 16
+    db 0x86, 2 ; DW_CFA_offset rbp, cfa - 16
+    db 0x43 ; DW_CFA_advance_loc 3
+    db 0x0D, 6 ; DW_CFA_def_cfa_register rbp
+    db 0x04 ; DW_CFA_advance_loc4
+    dd (%%end - 1) - (%1 + 4)
+    db 0x0C, 7, 8 ; DW_CFA_def_cfa rsp, 8
+    align 8, db 0 ; DW_CFA_nop
+%%fde_end:
+section .text
+%endmacro
+
 ; BUILTIN FATAL SUBROUTINE
 ; ========================
 ; func fatal(msg_start: *byte, msg_count: usize) void
@@ -84,6 +122,7 @@ sys.read:
     mov rsp, rbp
     pop rbp
     ret
+    __SYS_EH_FRAME_FDE sys.read
 
 ; linux/fs/read_write.c:
 ; SYSCALL_DEFINE3(write, unsigned int, fd, const char __user *, buf, size_t, count)
@@ -102,6 +141,7 @@ sys.write:
     mov rsp, rbp
     pop rbp
     ret
+    __SYS_EH_FRAME_FDE sys.write
 
 ; linux/fs/open.c:
 ; SYSCALL_DEFINE3(open, const char __user *, filename, int, flags, umode_t, mode)
@@ -120,6 +160,7 @@ sys.open:
     mov rsp, rbp
     pop rbp
     ret
+    __SYS_EH_FRAME_FDE sys.open
 
 ; linux/fs/open.c:
 ; SYSCALL_DEFINE1(close, unsigned int, fd)
@@ -136,6 +177,7 @@ sys.close:
     mov rsp, rbp
     pop rbp
     ret
+    __SYS_EH_FRAME_FDE sys.close
 
 ; linux/fs/read_write.c:
 ; SYSCALL_DEFINE3(lseek, unsigned int, fd, off_t, offset, unsigned int, whence)
@@ -154,6 +196,7 @@ sys.lseek:
     mov rsp, rbp
     pop rbp
     ret
+    __SYS_EH_FRAME_FDE sys.lseek
 
 ; arch/x86/kernel/sys_x86_64.c:
 ; SYSCALL_DEFINE6(mmap, unsigned long, addr, unsigned long, len, unsigned long, prot, unsigned long, flags, unsigned long, fd, unsigned long, off)
@@ -175,6 +218,7 @@ sys.mmap:
     mov rsp, rbp
     pop rbp
     ret
+    __SYS_EH_FRAME_FDE sys.mmap
 
 ; linux/mm/mmap.c:
 ; SYSCALL_DEFINE2(munmap, unsigned long, addr, size_t, len)
@@ -192,6 +236,7 @@ sys.munmap:
     mov rsp, rbp
     pop rbp
     ret
+    __SYS_EH_FRAME_FDE sys.munmap
 
 ; linux/kernel/exit.c:
 ; SYSCALL_DEFINE1(exit, int, error_code)
@@ -200,6 +245,9 @@ sys.exit:
     push rbp
     mov rbp, rsp
 
+%ifdef __profile
+    call __profile_write
+%endif
     mov rax, __SYS_EXIT
     mov rdi, [rbp + 0x10] ; error_code
     syscall
@@ -220,6 +268,7 @@ sys.mkdir:
     mov rsp, rbp
     pop rbp
     ret
+    __SYS_EH_FRAME_FDE sys.mkdir
 
 ; linux/fs/namei.c:
 ; SYSCALL_DEFINE1(rmdir, const char __user *, pathname)
@@ -236,6 +285,7 @@ sys.rmdir:
     mov rsp, rbp
     pop rbp
     ret
+    __SYS_EH_FRAME_FDE sys.rmdir
 
 ; linux/fs/namei.c:
 ; SYSCALL_DEFINE1(unlink, const char __user *, pathname)
@@ -252,6 +302,7 @@ sys.unlink:
     mov rsp, rbp
     pop rbp
     ret
+    __SYS_EH_FRAME_FDE sys.unlink
 
 ; linux/fs/readdir.c:
 ; SYSCALL_DEFINE3(getdents64, unsigned int, fd, struct linux_dirent64 __user *, dirent, unsigned int, count)
@@ -271,6 +322,7 @@ sys.getdents64:
     mov rsp, rbp
     pop rbp
     ret
+    __SYS_EH_FRAME_FDE sys.getdents
 
 section .data
 sys.argc: dq 0 ; extern var argc: usize;
@@ -317,6 +369,7 @@ sys.allocate:
     mov rsp, rbp
     pop rbp
     ret
+    __SYS_EH_FRAME_FDE sys.allocate
 
 ; SYS DEALLOCATE SUBROUTINE
 ; =========================
@@ -347,6 +400,7 @@ sys.deallocate:
     mov rsp, rbp
     pop rbp
     ret
+    __SYS_EH_FRAME_FDE sys.deallocate
 
 ; SYS DUMP_BYTES SUBROUTINE
 ; =========================
@@ -464,6 +518,7 @@ sys.dump_bytes:
     mov rsp, rbp
     pop rbp
     ret
+    __SYS_EH_FRAME_FDE sys.dump_bytes
 
 section .rodata
 sys._dump_nl_start: db 0x0A
@@ -502,81 +557,2931 @@ sys._dump_lookup_table: db \
     'F0', 'F1', 'F2', 'F3', 'F4', 'F5', 'F6', 'F7', \
     'F8', 'F9', 'FA', 'FB', 'FC', 'FD', 'FE', 'FF'
 
+; SYS BACKTRACE SUBROUTINE
+; ========================
+; func backtrace(addresses: *usize, count: usize) usize
+;
+; Store the return addresses of up to count active stack frames into
+; addresses, starting with the return address of the caller, by following the
+; chain of saved frame pointers. Must behave identically to `sys_backtrace` in
+; sys.h.
+;
+; ## Stack
+; +--------------------+ <- rbp + 0x28
+; | return value       |
+; +--------------------+ <- rbp + 0x20
+; | addresses          |
+; +--------------------+ <- rbp + 0x18
+; | count              |
+; +--------------------+ <- rbp + 0x10
+; | return address     |
+; +--------------------+ <- rbp + 0x08
+; | saved rbp          |
+; +--------------------+ <- rbp
+;
+; ## Registers
+; rax := number of addresses stored
+; rdi := addresses
+; rcx := count
+; rsi := frame
+; rdx := next frame / return address
+; r8  := base of the stack (argv)
+section .text
+sys.backtrace:
+    push rbp
+    mov rbp, rsp
+
+    mov rdi, [rbp + 0x18] ; addresses
+    mov rcx, [rbp + 0x10] ; count
+    mov r8, [sys.argv]
+    mov rsi, rbp
+    xor eax, eax
+
+.loop:
+    cmp rax, rcx
+    jae .done
+    mov rdx, [rsi]
+    cmp rdx, rsi
+    jbe .done
+    cmp rdx, r8
+    jae .done
+    test rdx, 7
+    jnz .done
+    mov rsi, rdx
+    mov rdx, [rsi + 0x08]
+    mov [rdi + rax * 8], rdx
+    inc rax
+    jmp .loop
+
+.done:
+    mov [rbp + 0x20], rax
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE sys.backtrace
+
+; SYS BIT MANIPULATION SUBROUTINES
+; ================================
+; Direct calls to these subroutines are lowered to the same instruction
+; sequences inline by the compiler. These definitions are used when the
+; functions are called indirectly through a function pointer.
+
+; Unary operation, %1 := instruction sequence operating on [rbp + 0x10] and
+; leaving the result in rax
+%macro __SYS_BITS_UNARY 1-*
+    push rbp
+    mov rbp, rsp
+    %rep %0
+    %1
+    %rotate 1
+    %endrep
+    mov [rbp + 0x18], rax
+    mov rsp, rbp
+    pop rbp
+    ret
+%endmacro
+
+; Count ones, %1 := instruction loading the argument at [rbp + 0x10] into rax
+; (zero extended to 64 bits)
+;
+; The popcnt instruction is not part of the baseline x86-64 instruction set,
+; so bits are counted in parallel within rax.
+%macro __SYS_BITS_COUNT_ONES 1
+    push rbp
+    mov rbp, rsp
+    %1
+    mov rcx, rax
+    shr rcx, 1
+    mov rbx, 0x5555555555555555
+    and rcx, rbx
+    sub rax, rcx
+    mov rcx, rax
+    shr rcx, 2
+    mov rbx, 0x3333333333333333
+    and rax, rbx
+    and rcx, rbx
+    add rax, rcx
+    mov rcx, rax
+    shr rcx, 4
+    add rax, rcx
+    mov rbx, 0x0F0F0F0F0F0F0F0F
+    and rax, rbx
+    mov rbx, 0x0101010101010101
+    imul rax, rbx
+    shr rax, 56
+    mov [rbp + 0x18], rax
+    mov rsp, rbp
+    pop rbp
+    ret
+%endmacro
+
+; Rotate, %1 := register, %2 := rol or ror
+%macro __SYS_BITS_ROTATE 2
+    push rbp
+    mov rbp, rsp
+    mov %1, [rbp + 0x18]
+    mov rcx, [rbp + 0x10]
+    %2 %1, cl
+    mov [rbp + 0x20], %1
+    mov rsp, rbp
+    pop rbp
+    ret
+%endmacro
+
+section .text
+sys.u32_count_ones:
+    __SYS_BITS_COUNT_ONES {mov eax, dword [rbp + 0x10]}
+    __SYS_EH_FRAME_FDE sys.u32_count_ones
+sys.u64_count_ones:
+    __SYS_BITS_COUNT_ONES {mov rax, qword [rbp + 0x10]}
+    __SYS_EH_FRAME_FDE sys.u64_count_ones
+sys.u32_leading_zeros:
+    __SYS_BITS_UNARY {mov ebx, -1}, {bsr eax, dword [rbp + 0x10]}, {cmovz eax, ebx}, {neg eax}, {add eax, 31}
+    __SYS_EH_FRAME_FDE sys.u32_leading_zeros
+sys.u64_leading_zeros:
+    __SYS_BITS_UNARY {mov rbx, -1}, {bsr rax, qword [rbp + 0x10]}, {cmovz rax, rbx}, {neg rax}, {add rax, 63}
+    __SYS_EH_FRAME_FDE sys.u64_leading_zeros
+sys.u32_trailing_zeros:
+    __SYS_BITS_UNARY {mov ebx, 32}, {bsf eax, dword [rbp + 0x10]}, {cmovz eax, ebx}
+    __SYS_EH_FRAME_FDE sys.u32_trailing_zeros
+sys.u64_trailing_zeros:
+    __SYS_BITS_UNARY {mov rbx, 64}, {bsf rax, qword [rbp + 0x10]}, {cmovz rax, rbx}
+    __SYS_EH_FRAME_FDE sys.u64_trailing_zeros
+sys.u16_byte_swap:
+    __SYS_BITS_UNARY {movzx eax, word [rbp + 0x10]}, {rol ax, 8}
+    __SYS_EH_FRAME_FDE sys.u16_byte_swap
+sys.u32_byte_swap:
+    __SYS_BITS_UNARY {mov eax, [rbp + 0x10]}, {bswap eax}
+    __SYS_EH_FRAME_FDE sys.u32_byte_swap
+sys.u64_byte_swap:
+    __SYS_BITS_UNARY {mov rax, [rbp + 0x10]}, {bswap rax}
+    __SYS_EH_FRAME_FDE sys.u64_byte_swap
+
+section .text
+sys.u8_rotate_left:
+    __SYS_BITS_ROTATE al, rol
+    __SYS_EH_FRAME_FDE sys.u8_rotate_left
+sys.u16_rotate_left:
+    __SYS_BITS_ROTATE ax, rol
+    __SYS_EH_FRAME_FDE sys.u16_rotate_left
+sys.u32_rotate_left:
+    __SYS_BITS_ROTATE eax, rol
+    __SYS_EH_FRAME_FDE sys.u32_rotate_left
+sys.u64_rotate_left:
+    __SYS_BITS_ROTATE rax, rol
+    __SYS_EH_FRAME_FDE sys.u64_rotate_left
+sys.u8_rotate_right:
+    __SYS_BITS_ROTATE al, ror
+    __SYS_EH_FRAME_FDE sys.u8_rotate_right
+sys.u16_rotate_right:
+    __SYS_BITS_ROTATE ax, ror
+    __SYS_EH_FRAME_FDE sys.u16_rotate_right
+sys.u32_rotate_right:
+    __SYS_BITS_ROTATE eax, ror
+    __SYS_EH_FRAME_FDE sys.u32_rotate_right
+sys.u64_rotate_right:
+    __SYS_BITS_ROTATE rax, ror
+    __SYS_EH_FRAME_FDE sys.u64_rotate_right
+
+; SYS BYTES_COMPARE SUBROUTINE
+; ============================
+; func bytes_compare(lhs: *byte, rhs: *byte, count: usize) ssize
+;
+; Compares sixteen bytes per iteration with SSE2, falling back to comparing
+; one byte per iteration for the remaining bytes. Returns -1, 0, or +1.
+;
+; ## Stack
+; +--------------------+ <- rbp + 0x30
+; | return value       |
+; +--------------------+ <- rbp + 0x28
+; | lhs                |
+; +--------------------+ <- rbp + 0x20
+; | rhs                |
+; +--------------------+ <- rbp + 0x18
+; | count              |
+; +--------------------+ <- rbp + 0x10
+; | return address     |
+; +--------------------+ <- rbp + 0x08
+; | saved rbp          |
+; +--------------------+ <- rbp
+section .text
+sys.bytes_compare:
+    push rbp
+    mov rbp, rsp
+
+    mov rsi, [rbp + 0x20] ; lhs
+    mov rdi, [rbp + 0x18] ; rhs
+    mov rcx, [rbp + 0x10] ; count
+
+.loop16:
+    cmp rcx, 16
+    jb .loop1
+    movdqu xmm0, [rsi]
+    movdqu xmm1, [rdi]
+    pcmpeqb xmm0, xmm1
+    pmovmskb edx, xmm0
+    xor edx, 0xFFFF ; one bits mark the differing bytes
+    jnz .differ
+    add rsi, 16
+    add rdi, 16
+    sub rcx, 16
+    jmp .loop16
+
+.differ:
+    bsf edx, edx ; index of the first differing byte
+    movzx eax, byte [rsi + rdx]
+    movzx ecx, byte [rdi + rdx]
+    sub rax, rcx
+    jmp .sign
+
+.loop1:
+    test rcx, rcx
+    jz .equal
+    movzx eax, byte [rsi]
+    movzx edx, byte [rdi]
+    sub rax, rdx
+    jnz .sign
+    inc rsi
+    inc rdi
+    dec rcx
+    jmp .loop1
+
+.equal:
+    xor eax, eax
+    jmp .return
+
+.sign:
+    ; rax := -1 if rax is negative else +1
+    sar rax, 63
+    or rax, 1
+
+.return:
+    mov [rbp + 0x28], rax
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE sys.bytes_compare
+
+; SYS BYTES_HASH SUBROUTINE
+; =========================
+; func bytes_hash(start: *byte, count: usize) usize
+;
+; Must produce results identical to `sys_bytes_hash` in sys.h.
+;
+; ## Stack
+; +--------------------+ <- rbp + 0x28
+; | return value       |
+; +--------------------+ <- rbp + 0x20
+; | start              |
+; +--------------------+ <- rbp + 0x18
+; | count              |
+; +--------------------+ <- rbp + 0x10
+; | return address     |
+; +--------------------+ <- rbp + 0x08
+; | saved rbp          |
+; +--------------------+ <- rbp
+;
+; ## Registers
+; rax := hash
+; rsi := start
+; rcx := count
+; r8  := multiplier
+section .text
+sys.bytes_hash:
+    push rbp
+    mov rbp, rsp
+
+    mov rsi, [rbp + 0x18] ; start
+    mov rcx, [rbp + 0x10] ; count
+    mov rax, 0x9E3779B97F4A7C15
+    xor rax, rcx
+    mov r8, 0x517CC1B727220A95
+
+.loop:
+    cmp rcx, 8
+    jb .tail
+    rol rax, 5
+    xor rax, [rsi]
+    imul rax, r8
+    add rsi, 8
+    sub rcx, 8
+    jmp .loop
+
+.tail:
+    test rcx, rcx
+    jz .finish
+    ; rdx := remaining bytes as a zero-extended little endian word
+    xor edx, edx
+.tail_loop:
+    dec rcx
+    shl rdx, 8
+    movzx r9d, byte [rsi + rcx]
+    or rdx, r9
+    test rcx, rcx
+    jnz .tail_loop
+    rol rax, 5
+    xor rax, rdx
+    imul rax, r8
+
+.finish:
+    mov rdx, rax
+    shr rdx, 32
+    xor rax, rdx
+    mov r8, 0x94D049BB133111EB
+    imul rax, r8
+    mov rdx, rax
+    shr rdx, 29
+    xor rax, rdx
+
+    mov [rbp + 0x20], rax
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE sys.bytes_hash
+
+; SYS ASCII CASE CONVERSION SUBROUTINES
+; =====================================
+; func ascii_to_lowercase(start: *byte, count: usize) void
+; func ascii_to_uppercase(start: *byte, count: usize) void
+;
+; Sixteen bytes are converted per iteration with SSE2. Adding the bias maps
+; the letters to be converted onto the signed byte range [-128, -103], so
+; a single signed comparison selects them, and toggling bit 0x20 of the
+; selected bytes converts their case.
+;
+; %1 := first letter to convert, %2 := bias
+%macro __SYS_ASCII_CONVERT 2
+    push rbp
+    mov rbp, rsp
+
+    mov rsi, [rbp + 0x18] ; start
+    mov rcx, [rbp + 0x10] ; count
+    movdqu xmm2, [%2]
+    movdqu xmm3, [sys._ascii_threshold]
+    movdqu xmm4, [sys._ascii_case_bit]
+
+%%loop16:
+    cmp rcx, 16
+    jb %%loop1
+    movdqu xmm0, [rsi]
+    movdqa xmm1, xmm0
+    paddb xmm1, xmm2
+    movdqa xmm5, xmm3
+    pcmpgtb xmm5, xmm1 ; threshold > biased
+    pand xmm5, xmm4
+    pxor xmm0, xmm5
+    movdqu [rsi], xmm0
+    add rsi, 16
+    sub rcx, 16
+    jmp %%loop16
+
+%%loop1:
+    test rcx, rcx
+    jz %%return
+    movzx eax, byte [rsi]
+    sub eax, %1
+    cmp eax, 25
+    ja %%next
+    xor byte [rsi], 0x20
+%%next:
+    inc rsi
+    dec rcx
+    jmp %%loop1
+
+%%return:
+    mov rsp, rbp
+    pop rbp
+    ret
+%endmacro
+
+section .text
+sys.ascii_to_lowercase:
+    __SYS_ASCII_CONVERT 'A', sys._ascii_lowercase_bias
+    __SYS_EH_FRAME_FDE sys.ascii_to_lowercase
+sys.ascii_to_uppercase:
+    __SYS_ASCII_CONVERT 'a', sys._ascii_uppercase_bias
+    __SYS_EH_FRAME_FDE sys.ascii_to_uppercase
+
+section .rodata
+sys._ascii_lowercase_bias: times 16 db 0x80 - 'A'
+sys._ascii_uppercase_bias: times 16 db 0x80 - 'a'
+sys._ascii_threshold: times 16 db 0x80 + 26
+sys._ascii_case_bit: times 16 db 0x20
+
+; IEEE-754 CONSTANTS
+; ==================
+section .rodata
+sys._ieee754_f64_inf: dq 0x7FF0000000000000
+sys._ieee754_f64_nan: dq 0x7FF8000000000000
+sys._ieee754_f32_half: dd 0.5
+sys._ieee754_f32_three: dd 3.0
+sys._ieee754_f32_exp2_limit: dd 20000.0
+sys._ieee754_f32_log1p_limit: dd 0.29
+sys._ieee754_f32_tanh_limit: dd 0.34
+sys._ieee754_f32_reduce_limit: dd 0x4F000000 ; 2^31
+sys._ieee754_f64_pi_over_4: dq 0x3FE921FB54442D18
+sys._ieee754_f64_2_over_pi: dq 0x3FE45F306DC9C883
+; pi/2 split into 32 + 32 + 53 significant bits such that n * P1 and n * P2 are
+; exact in the x87 64-bit significand for n < 2^32.
+sys._ieee754_f64_pi_over_2_p1: dq 0x3FF921FB54400000
+sys._ieee754_f64_pi_over_2_p2: dq 0x3DD0B4611A600000
+sys._ieee754_f64_pi_over_2_p3: dq 0x3BA3198A2E037073
+sys._ieee754_f32_2_pow_m63: dd 0x20000000
+sys._ieee754_f32_2_pow_m64: dd 0x1F800000
+; The first 1216 fractional bits of 2/pi, most significant first.
+sys._ieee754_2_over_pi_bits: \
+    dq 0xA2F9836E4E441529, 0xFC2757D1F534DDC0, 0xDB6295993C439041, \
+       0xFE5163ABDEBBC561, 0xB7246E3A424DD2E0, 0x06492EEA09D1921C, \
+       0xFE1DEB1CB129A73E, 0xE88235F52EBB4484, 0xE99C7026B45F7E41, \
+       0x3991D639835339F4, 0x9C845F8BBDF9283B, 0x1FF897FFDE05980F, \
+       0xEF2F118B5A0A6D1F, 0x6D367ECF27CB09B7, 0x4F463F669E5FEA2D, \
+       0x7527BAC7EBE5F17B, 0x3D0739F78A5292EA, 0x6BFB5FB11F8D5D08, \
+       0x56033046FC7B6BAB
+; nextafter(0.5, 0.0) with positive and negative sign.
+sys._ieee754_f32_round_bias: dd 0x3EFFFFFF, 0xBEFFFFFF
+sys._ieee754_f64_round_bias: dq 0x3FDFFFFFFFFFFFFF, 0xBFDFFFFFFFFFFFFF
+; Binary places to shift a decimal with n integral digits by, indexed by n.
+sys._ieee754_powtab: db 1, 3, 6, 9, 13, 16, 19, 23, 26
+sys._ieee754_powtab_count: equ $ - sys._ieee754_powtab
+
+sys._ieee754_str_nan_start: db "NaN"
+sys._ieee754_str_nan_count: equ $ - sys._ieee754_str_nan_start
+sys._ieee754_str_pinf_start: db "+infinity"
+sys._ieee754_str_pinf_count: equ $ - sys._ieee754_str_pinf_start
+sys._ieee754_str_ninf_start: db "-infinity"
+sys._ieee754_str_ninf_count: equ $ - sys._ieee754_str_ninf_start
+
+; IEEE-754 X87 KERNELS
+; ====================
+; Each kernel replaces the value(s) on top of the x87 register stack with the
+; result of the operation. The x87 unit operates on 64-bit significands, so
+; kernels are evaluated with eleven guard bits for f64 (and forty for f32)
+; before the final rounding store. Kernels may clobber any general purpose
+; register.
+
+; st0 := 2^st0
+%macro __x87_exp2 0
+    ; Clamp the exponent to [-limit, +limit] so that the integral part fits in
+    ; fscale and infinities do not produce inf - inf.
+    fld dword [sys._ieee754_f32_exp2_limit]
+    fxch
+    fucomi st0, st1
+    fcmovnb st0, st1
+    fstp st1
+    fld dword [sys._ieee754_f32_exp2_limit]
+    fchs
+    fucomi st0, st1
+    fcmovb st0, st1
+    fstp st1
+    ; 2^t = 2^(t - round(t)) * 2^round(t) with |t - round(t)| <= 0.5
+    fld st0
+    frndint
+    fsub st1, st0
+    fxch
+    f2xm1
+    fld1
+    faddp st1, st0
+    fscale
+    fstp st1
+%endmacro
+
+; st0 := ln(st0)
+%macro __x87_ln 0
+    fldln2
+    fxch
+    fyl2x
+%endmacro
+
+; st0 := log2(st0)
+%macro __x87_log2 0
+    fld1
+    fxch
+    fyl2x
+%endmacro
+
+; st0 := log10(st0)
+%macro __x87_log10 0
+    fldlg2
+    fxch
+    fyl2x
+%endmacro
+
+; st0 := ln(1 + st0)
+%macro __x87_log1p 0
+    fldln2
+    fxch
+    fld st0
+    fabs
+    fld dword [sys._ieee754_f32_log1p_limit]
+    fucomip st0, st1
+    fstp st0
+    jbe %%large
+    ; fyl2xp1 is only defined for |st0| < 1 - sqrt(2)/2.
+    fyl2xp1
+    jmp %%done
+%%large:
+    fld1
+    faddp st1, st0
+    fyl2x
+%%done:
+%endmacro
+
+; st0 := copysign(st0, st1), popping st1
+%macro __x87_copysign 0
+    fxch
+    fxam
+    fnstsw ax
+    fstp st0
+    test ax, 0x0200 ; C1 := sign bit
+    jz %%done
+    fchs
+%%done:
+%endmacro
+
+; st0 := cbrt(st0)
+%macro __x87_cbrt 0
+    fld st0
+    fabs
+    ; cbrt(x) = x for x in {+/-0, +/-inf, NaN}
+    fldz
+    fucomip st0, st1
+    je %%identity
+    fld qword [sys._ieee754_f64_inf]
+    fucomip st0, st1
+    je %%identity
+    ; y := cbrt(|x|) ~ 2^(log2(|x|) / 3)
+    fld st0
+    __x87_log2
+    fdiv dword [sys._ieee754_f32_three]
+    __x87_exp2
+    ; One Newton step y := y - (y^3 - |x|) / (3 * y^2) corrects the error of
+    ; the logarithm and exponential kernels.
+    fld st0
+    fmul st0, st0
+    fld st0
+    fmul st0, st2
+    fsub st0, st3
+    fxch
+    fmul dword [sys._ieee754_f32_three]
+    fdivp st1, st0
+    fsubp st1, st0
+    fstp st1
+    __x87_copysign
+    jmp %%done
+%%identity:
+    fstp st0
+%%done:
+%endmacro
+
+; st0 := sqrt(st1^2 + st0^2), popping st1
+%macro __x87_hypot 0
+    fabs
+    fxch
+    fabs
+    ; hypot(+/-inf, y) = hypot(x, +/-inf) = +inf, even if the other is NaN
+    fld qword [sys._ieee754_f64_inf]
+    fucomi st0, st1
+    jp %%not_infinite_x
+    je %%infinite
+%%not_infinite_x:
+    fucomi st0, st2
+    jp %%not_infinite_y
+    je %%infinite
+%%not_infinite_y:
+    fstp st0
+    ; Squares of finite f32/f64 values cannot overflow the x87 exponent range.
+    fmul st0, st0
+    fxch
+    fmul st0, st0
+    faddp st1, st0
+    fsqrt
+    jmp %%done
+%%infinite:
+    fstp st1
+    fstp st1
+%%done:
+%endmacro
+
+; st0 := pow(st1, st0), popping st1
+%macro __x87_pow 0
+    xor r8d, r8d ; r8 := 1 if the result is negated
+    ; pow(x, +/-0) = 1 for any x, even NaN
+    fldz
+    fucomip st0, st1
+    jp %%check_one
+    je %%one
+%%check_one:
+    ; pow(+1, y) = 1 for any y, even NaN
+    fld1
+    fucomip st0, st2
+    jp %%general
+    je %%one
+    fucomi st0, st0
+    jp %%general
+    ; pow(-1, +/-inf) = 1
+    fld st0
+    fabs
+    fld qword [sys._ieee754_f64_inf]
+    fucomip st0, st1
+    fstp st0
+    jne %%finite_exponent
+    fld st1
+    fabs
+    fld1
+    fucomip st0, st1
+    fstp st0
+    je %%one
+    jmp %%general
+%%finite_exponent:
+    ; Negative bases require an integral exponent, and odd integral exponents
+    ; negate the result.
+    fld st1
+    fxam
+    fnstsw ax
+    fstp st0
+    test ax, 0x0200 ; C1 := sign bit
+    jz %%general
+    fld st0
+    frndint
+    fucomip st0, st1
+    jne %%fractional_exponent
+    fld st0
+    fmul dword [sys._ieee754_f32_half]
+    fld st0
+    frndint
+    fucomip st0, st1
+    fstp st0
+    je %%general
+    mov r8d, 1
+    jmp %%general
+%%fractional_exponent:
+    ; pow(-0, y) and pow(-inf, y) are defined for non-integral y, but any
+    ; other negative base produces NaN.
+    fld st1
+    fabs
+    fld qword [sys._ieee754_f64_inf]
+    fucomip st0, st1
+    fstp st0
+    je %%general
+    fldz
+    fucomip st0, st2
+    je %%general
+    fstp st0
+    fstp st0
+    fld qword [sys._ieee754_f64_nan]
+    jmp %%done
+%%general:
+    ; pow(x, y) = 2^(y * log2(|x|))
+    fxch
+    fabs
+    fyl2x
+    __x87_exp2
+    test r8d, r8d
+    jz %%done
+    fchs
+    jmp %%done
+%%one:
+    fstp st0
+    fstp st0
+    fld1
+%%done:
+%endmacro
+
+; Reduce st0 to r with x = r + n * pi/2 and |r| <= ~pi/4, leaving the
+; quadrant n mod 4 in eax. Arguments below 2^31 use a three-part Cody-Waite
+; reduction. Larger arguments use a Payne-Hanek reduction, multiplying the
+; 53-bit significand by a 192-bit window of 2/pi selected by the exponent.
+; Infinities and NaNs are left untouched.
+%macro __x87_reduce 0
+    xor eax, eax
+    fld st0
+    fabs
+    fld qword [sys._ieee754_f64_pi_over_4]
+    fucomip st0, st1
+    jae %%done_pop
+    fld dword [sys._ieee754_f32_reduce_limit]
+    fucomip st0, st1
+    fstp st0
+    ja %%cody_waite
+
+    sub rsp, 0x28
+    fst qword [rsp]
+    mov rax, [rsp]
+    mov r9, rax
+    shr r9, 63              ; r9 := sign
+    shr rax, 52
+    and eax, 0x7FF
+    cmp eax, 0x7FF
+    je %%non_finite
+    fstp st0
+    mov rsi, 0x000FFFFFFFFFFFFF
+    and rsi, [rsp]
+    bts rsi, 52             ; rsi := m
+    sub rax, 1075           ; rax := k where |x| = m * 2^k
+    ; Bits of 2/pi contributing multiples of four are skipped, so the window
+    ; starts at fractional bit s = max(1, k - 1), and the quadrant lies at bit
+    ; t = s + 191 - k of the product.
+    lea rcx, [rax - 1]
+    mov rdx, 1
+    cmp rcx, 1
+    cmovl rcx, rdx
+    lea r10, [rcx + 191]
+    sub r10, rax            ; r10 := t
+    dec rcx
+    mov rdi, rcx
+    shr rdi, 6
+    lea r11, [sys._ieee754_2_over_pi_bits]
+    lea rdi, [r11 + rdi*8]
+    and ecx, 63
+    mov r8, [rdi]
+    mov rdx, [rdi + 8]
+    shld r8, rdx, cl        ; r8 := W2
+    mov r11, [rdi + 8]
+    mov rdx, [rdi + 16]
+    shld r11, rdx, cl       ; r11 := W1
+    mov rax, [rdi + 16]
+    mov rdx, [rdi + 24]
+    shld rax, rdx, cl       ; rax := W0
+    ; [rsp] := m * (W2:W1:W0)
+    mul rsi
+    mov [rsp], rax
+    mov rdi, rdx
+    mov rax, r11
+    mul rsi
+    add rdi, rax
+    adc rdx, 0
+    mov [rsp + 0x8], rdi
+    mov rdi, rdx
+    mov rax, r8
+    mul rsi
+    add rdi, rax
+    adc rdx, 0
+    mov [rsp + 0x10], rdi
+    mov [rsp + 0x18], rdx
+    mov qword [rsp + 0x20], 0
+    ; r8 := product bits [t - 128, t - 64), r11 := [t - 64, t), eax := [t, t + 2)
+    lea rcx, [r10 - 128]
+    mov rdx, rcx
+    shr rdx, 6
+    and ecx, 63
+    mov r8, [rsp + rdx*8]
+    mov rdi, [rsp + rdx*8 + 8]
+    shrd r8, rdi, cl
+    lea rcx, [r10 - 64]
+    mov rdx, rcx
+    shr rdx, 6
+    and ecx, 63
+    mov r11, [rsp + rdx*8]
+    mov rdi, [rsp + rdx*8 + 8]
+    shrd r11, rdi, cl
+    mov rcx, r10
+    mov rdx, rcx
+    shr rdx, 6
+    and ecx, 63
+    mov rax, [rsp + rdx*8]
+    mov rdi, [rsp + rdx*8 + 8]
+    shrd rax, rdi, cl
+    ; Treating the fraction as signed centers r in [-1/2, 1/2) quadrants.
+    mov rdx, r11
+    shr rdx, 63
+    add eax, edx
+    ; r := (r11 + (r8 >> 1) * 2^-63) * 2^-64 * pi/2
+    shr r8, 1
+    mov [rsp], r8
+    fild qword [rsp]
+    fmul dword [sys._ieee754_f32_2_pow_m63]
+    mov [rsp], r11
+    fild qword [rsp]
+    faddp st1, st0
+    fmul dword [sys._ieee754_f32_2_pow_m64]
+    fldpi
+    fmulp st1, st0
+    fmul dword [sys._ieee754_f32_half]
+    add rsp, 0x28
+    test r9, r9
+    jz %%quadrant
+    fchs
+    neg eax
+%%quadrant:
+    and eax, 3
+    jmp %%done
+%%non_finite:
+    add rsp, 0x28
+    xor eax, eax
+    jmp %%done_pop
+
+%%cody_waite:
+    ; n := round(x * 2/pi)
+    fld st0
+    fmul qword [sys._ieee754_f64_2_over_pi]
+    frndint
+    sub rsp, 0x8
+    fist dword [rsp]
+    mov eax, [rsp]
+    add rsp, 0x8
+    and eax, 3
+    ; r := ((x - n * P1) - n * P2) - n * P3
+    fld st0
+    fmul qword [sys._ieee754_f64_pi_over_2_p1]
+    fsubp st2, st0
+    fld st0
+    fmul qword [sys._ieee754_f64_pi_over_2_p2]
+    fsubp st2, st0
+    fmul qword [sys._ieee754_f64_pi_over_2_p3]
+    fsubp st1, st0
+    jmp %%done
+%%done_pop:
+    fstp st0
+%%done:
+%endmacro
+
+; st0 := sin(st0)
+%macro __x87_sin 0
+    __x87_reduce
+    test eax, 1
+    jnz %%odd
+    fsin
+    jmp %%sign
+%%odd:
+    fcos
+%%sign:
+    test eax, 2
+    jz %%done
+    fchs
+%%done:
+%endmacro
+
+; st0 := cos(st0)
+%macro __x87_cos 0
+    __x87_reduce
+    test eax, 1
+    jnz %%odd
+    fcos
+    jmp %%sign
+%%odd:
+    fsin
+%%sign:
+    inc eax
+    test eax, 2
+    jz %%done
+    fchs
+%%done:
+%endmacro
+
+; st0 := tan(st0)
+%macro __x87_tan 0
+    __x87_reduce
+    fptan
+    test eax, 1
+    jnz %%odd
+    fstp st0 ; fptan pushes 1.0 after the result
+    jmp %%done
+%%odd:
+    ; tan(r + pi/2) = -1 / tan(r)
+    fdivrp st1, st0
+    fchs
+%%done:
+%endmacro
+
+; st0 := asin(st0) = atan2(x, sqrt((1 - x) * (1 + x)))
+%macro __x87_asin 0
+    fld1
+    fsub st0, st1
+    fld1
+    fadd st0, st2
+    fmulp st1, st0
+    fsqrt
+    fpatan
+%endmacro
+
+; st0 := acos(st0) = atan2(sqrt((1 - x) * (1 + x)), x)
+%macro __x87_acos 0
+    fld1
+    fsub st0, st1
+    fld1
+    fadd st0, st2
+    fmulp st1, st0
+    fsqrt
+    fxch
+    fpatan
+%endmacro
+
+; st0 := atan(st0)
+%macro __x87_atan 0
+    fld1
+    fpatan
+%endmacro
+
+; st0 := atan2(st1, st0), popping st1
+%macro __x87_atan2 0
+    fpatan
+%endmacro
+
+; st0 := sinh(st0)
+%macro __x87_sinh 0
+    fld st0
+    fabs
+    fld dword [sys._ieee754_f32_half]
+    fucomip st0, st1
+    jbe %%large
+    ; sinh(r) = (u + u / (u + 1)) / 2 where u = expm1(r) avoids cancellation
+    ; for small r.
+    fldl2e
+    fmulp st1, st0
+    f2xm1
+    fld st0
+    fld1
+    fadd st0, st1
+    fdivp st1, st0
+    faddp st1, st0
+    jmp %%halve
+%%large:
+    ; sinh(r) = (e - 1/e) / 2 where e = exp(r)
+    fldl2e
+    fmulp st1, st0
+    __x87_exp2
+    fld1
+    fdiv st0, st1
+    fsubp st1, st0
+%%halve:
+    fmul dword [sys._ieee754_f32_half]
+    __x87_copysign
+%endmacro
+
+; st0 := cosh(st0) = (e + 1/e) / 2 where e = exp(|x|)
+%macro __x87_cosh 0
+    fabs
+    fldl2e
+    fmulp st1, st0
+    __x87_exp2
+    fld1
+    fdiv st0, st1
+    faddp st1, st0
+    fmul dword [sys._ieee754_f32_half]
+%endmacro
+
+; st0 := tanh(st0)
+%macro __x87_tanh 0
+    fld st0
+    fabs
+    fld dword [sys._ieee754_f32_tanh_limit]
+    fucomip st0, st1
+    jbe %%large
+    ; tanh(r) = u / (u + 2) where u = expm1(2r)
+    fadd st0, st0
+    fldl2e
+    fmulp st1, st0
+    f2xm1
+    fld st0
+    fld1
+    fadd st0, st0
+    faddp st1, st0
+    fdivp st1, st0
+    jmp %%sign
+%%large:
+    ; tanh(r) = (1 - e) / (1 + e) where e = exp(-2r)
+    fadd st0, st0
+    fchs
+    fldl2e
+    fmulp st1, st0
+    __x87_exp2
+    fld1
+    fsub st0, st1
+    fld1
+    faddp st2, st0
+    fdivrp st1, st0
+%%sign:
+    __x87_copysign
+%endmacro
+
+; st0 := asinh(st0)
+%macro __x87_asinh 0
+    fld st0
+    fabs
+    fld dword [sys._ieee754_f32_half]
+    fucomip st0, st1
+    jbe %%large
+    ; asinh(r) = log1p(r + r^2 / (1 + sqrt(1 + r^2)))
+    fld st0
+    fmul st0, st0
+    fld st0
+    fld1
+    faddp st1, st0
+    fsqrt
+    fld1
+    faddp st1, st0
+    fdivp st1, st0
+    faddp st1, st0
+    __x87_log1p
+    jmp %%sign
+%%large:
+    ; asinh(r) = ln(r + sqrt(r^2 + 1))
+    fld st0
+    fmul st0, st0
+    fld1
+    faddp st1, st0
+    fsqrt
+    faddp st1, st0
+    __x87_ln
+%%sign:
+    __x87_copysign
+%endmacro
+
+; st0 := acosh(st0) = log1p(t + sqrt(t) * sqrt(t + 2)) where t = x - 1
+%macro __x87_acosh 0
+    fld1
+    fsubp st1, st0
+    fld st0
+    fld1
+    fadd st0, st0
+    faddp st1, st0
+    fsqrt
+    fld st1
+    fsqrt
+    fmulp st1, st0
+    faddp st1, st0
+    __x87_log1p
+%endmacro
+
+; st0 := atanh(st0) = log1p(2r / (1 - r)) / 2 where r = |x|
+%macro __x87_atanh 0
+    fld st0
+    fabs
+    fld1
+    fsub st0, st1
+    fxch
+    fadd st0, st0
+    fdivrp st1, st0
+    __x87_log1p
+    fmul dword [sys._ieee754_f32_half]
+    __x87_copysign
+%endmacro
+
+; IEEE-754 FUNCTION BODIES
+; ========================
+; func f32_<unary>(x: f32) f32
+; func f64_<unary>(x: f64) f64
+;
+; ## Stack
+; +--------------------+ <- rbp + 0x20
+; | return value       |
+; +--------------------+ <- rbp + 0x18
+; | x                  |
+; +--------------------+ <- rbp + 0x10
+; | return address     |
+; +--------------------+ <- rbp + 0x08
+; | saved rbp          |
+; +--------------------+ <- rbp
+;
+; func f32_<binary>(x: f32, y: f32) f32
+; func f64_<binary>(x: f64, y: f64) f64
+;
+; ## Stack
+; +--------------------+ <- rbp + 0x28
+; | return value       |
+; +--------------------+ <- rbp + 0x20
+; | x                  |
+; +--------------------+ <- rbp + 0x18
+; | y                  |
+; +--------------------+ <- rbp + 0x10
+; | return address     |
+; +--------------------+ <- rbp + 0x08
+; | saved rbp          |
+; +--------------------+ <- rbp
+;
+; Each macro takes the operand size (dword or qword) or the SSE scalar suffix
+; (ss or sd) of the function being defined.
+
+; x87 unary function, %2 := kernel
+%macro __SYS_IEEE754_X87_UNARY 2
+    push rbp
+    mov rbp, rsp
+    fld %1 [rbp + 0x10]
+    %2
+    fstp %1 [rbp + 0x18]
+    mov rsp, rbp
+    pop rbp
+    ret
+%endmacro
+
+; x87 binary function, %2 := kernel
+%macro __SYS_IEEE754_X87_BINARY 2
+    push rbp
+    mov rbp, rsp
+    fld %1 [rbp + 0x18]
+    fld %1 [rbp + 0x10]
+    %2
+    fstp %1 [rbp + 0x20]
+    mov rsp, rbp
+    pop rbp
+    ret
+%endmacro
+
+; |x| via clearing the sign bit, %1 := register, %2 := sign bit index
+%macro __SYS_IEEE754_ABS 2
+    push rbp
+    mov rbp, rsp
+    mov %1, [rbp + 0x10]
+    btr %1, %2
+    mov [rbp + 0x18], %1
+    mov rsp, rbp
+    pop rbp
+    ret
+%endmacro
+
+; fmin/fmax, %2 := minss, minsd, maxss, or maxsd, %3 := bit index of the quiet
+; bit of a NaN
+;
+; A quiet NaN operand yields the other operand. A signaling NaN operand, or two
+; NaN operands, yields a quiet NaN (via addition) as with C fmin and fmax.
+%macro __SYS_IEEE754_MINMAX 3
+    push rbp
+    mov rbp, rsp
+    mov%1 xmm0, [rbp + 0x18]
+    mov%1 xmm1, [rbp + 0x10]
+    ucomi%1 xmm0, xmm1
+    jp .unordered
+    %2 xmm0, xmm1
+    jmp .return
+.unordered:
+    ucomi%1 xmm0, xmm0
+    jnp .y_is_nan
+    ucomi%1 xmm1, xmm1
+    jp .return_nan
+    mov rax, [rbp + 0x18]
+    bt rax, %3
+    jnc .return_nan
+    mov%1 xmm0, xmm1
+    jmp .return
+.y_is_nan:
+    mov rax, [rbp + 0x10]
+    bt rax, %3
+    jc .return
+.return_nan:
+    add%1 xmm0, xmm1
+.return:
+    mov%1 [rbp + 0x20], xmm0
+    mov rsp, rbp
+    pop rbp
+    ret
+%endmacro
+
+%macro __SYS_IEEE754_SQRT 1
+    push rbp
+    mov rbp, rsp
+    sqrt%1 xmm0, [rbp + 0x10]
+    mov%1 [rbp + 0x18], xmm0
+    mov rsp, rbp
+    pop rbp
+    ret
+%endmacro
+
+; SSE4.1 rounding, %2 := rounding control (precision exception suppressed)
+%macro __SYS_IEEE754_ROUNDING 2
+    push rbp
+    mov rbp, rsp
+    round%1 xmm0, [rbp + 0x10], %2
+    mov%1 [rbp + 0x18], xmm0
+    mov rsp, rbp
+    pop rbp
+    ret
+%endmacro
+
+; Round half away from zero as trunc(x + copysign(nextafter(0.5, 0.0), x)),
+; %2 := bias table, %3 := offset of the byte containing the sign bit
+%macro __SYS_IEEE754_ROUND 3
+    push rbp
+    mov rbp, rsp
+    mov%1 xmm0, [rbp + 0x10]
+    mov rax, %2
+    test byte [rbp + 0x10 + %3], 0x80
+    jz .bias
+    add rax, %3 + 1
+.bias:
+    add%1 xmm0, [rax]
+    round%1 xmm0, xmm0, __ROUND_TRUNC
+    mov%1 [rbp + 0x18], xmm0
+    mov rsp, rbp
+    pop rbp
+    ret
+%endmacro
+
+; Classification via the magnitude bits, %1 := register a, %2 := register b,
+; %3 := magnitude mask, %4 := magnitude of infinity, %5 := setcc condition
+%macro __SYS_IEEE754_CLASSIFY 5
+    push rbp
+    mov rbp, rsp
+    mov %1, [rbp + 0x10]
+    mov %2, %3
+    and %1, %2
+    mov %2, %4
+    cmp %1, %2
+    set%5 byte [rbp + 0x18]
+    mov rsp, rbp
+    pop rbp
+    ret
+%endmacro
+
+; Normal values have a magnitude in [smallest normal, infinity),
+; %1 := register a, %2 := register b, %3 := magnitude mask,
+; %4 := magnitude of infinity, %5 := smallest normal magnitude
+%macro __SYS_IEEE754_IS_NORMAL 5
+    push rbp
+    mov rbp, rsp
+    mov %1, [rbp + 0x10]
+    mov %2, %3
+    and %1, %2
+    mov %2, %4
+    cmp %1, %2
+    setb cl
+    mov %2, %5
+    cmp %1, %2
+    setae dl
+    and cl, dl
+    mov [rbp + 0x18], cl
+    mov rsp, rbp
+    pop rbp
+    ret
+%endmacro
+
+; SYS STR_TO_IEEE754 SUBROUTINE
+; =============================
+; Internal helper for sys.str_to_f32 and sys.str_to_f64.
+;
+; Accepts "infinity", "+infinity", "-infinity", "NaN", or a decimal number of
+; the form [+-]?[0-9]*(.[0-9]*)? containing at least one digit, and produces
+; the correctly rounded (half to even) bits of the parsed value.
+;
+; The significant digits (up to 800, with any further nonzero digit recorded as
+; truncated) are held as a decimal d[0:nd] with the decimal point before d[dp].
+; The decimal is repeatedly multiplied or divided by powers of two, exactly,
+; until it is in the range [0.5, 1), and is then multiplied by 2^(1+mantbits)
+; and rounded to an integer mantissa.
+;
+; ## Stack
+; +--------------------+ <- rbp
+; | bias               |
+; +--------------------+ <- rbp - 0x08
+; | digits (800 bytes) |
+; +--------------------+ <- rbp - 0x328
+; | scratch (832 bytes)|
+; +--------------------+ <- rbp - 0x668
+;
+; ## Registers
+; rsi := [in] start
+; rcx := [in] count
+; r8  := [in] number of mantissa bits (excluding the implicit bit)
+; r9  := [in] number of exponent bits
+; al  := [out] 1 on success, 0 on failure
+; rdx := [out] bits of the parsed value on success
+;
+; r10 := binary exponent
+; r11 := binary places to shift the decimal by
+; r12 := nd
+; r13 := dp
+; r14 := truncated flag
+; r15 := negative flag
+section .text
+sys._str_to_ieee754:
+    push rbp
+    mov rbp, rsp
+    sub rsp, 0x670
+
+.bias    equ -0x08
+.digits  equ -0x328
+.scratch equ -0x668
+
+    xor r15, r15
+    mov rdi, sys._ieee754_str_nan_start
+    cmp rcx, sys._ieee754_str_nan_count
+    jne .check_infinity
+    call .match
+    jne .parse
+    ; Quiet NaN with only the most significant mantissa bit set.
+    mov eax, 1
+    mov ecx, r8d
+    dec ecx
+    shl rax, cl
+    jmp .saturate
+
+.check_infinity:
+    mov rdi, sys._ieee754_str_pinf_start + 1
+    cmp rcx, sys._ieee754_str_pinf_count - 1
+    jne .check_signed_infinity
+    call .match
+    jne .parse
+    jmp .infinity
+
+.check_signed_infinity:
+    cmp rcx, sys._ieee754_str_pinf_count
+    jne .parse
+    mov rdi, sys._ieee754_str_pinf_start
+    call .match
+    je .infinity
+    mov rdi, sys._ieee754_str_ninf_start
+    call .match
+    jne .parse
+    mov r15, 1
+    jmp .infinity
+
+.parse:
+    xor r12, r12
+    xor r13, r13
+    xor r14, r14
+    xor ebx, ebx  ; significant digits, including those beyond d[799]
+    xor r10, r10  ; seen decimal separator flag
+    xor r11, r11  ; digit count
+    mov rdi, rsi
+    add rdi, rcx
+
+    cmp rsi, rdi
+    je .failure
+    cmp byte [rsi], '+'
+    je .skip_sign
+    cmp byte [rsi], '-'
+    jne .digit
+    mov r15, 1
+.skip_sign:
+    inc rsi
+
+.digit:
+    cmp rsi, rdi
+    je .digit_done
+    movzx eax, byte [rsi]
+    inc rsi
+    cmp al, '.'
+    je .separator
+    sub al, '0'
+    cmp al, 9
+    ja .failure
+    inc r11
+    test rbx, rbx
+    jnz .significant
+    test al, al
+    jnz .significant
+    dec r13 ; leading zeros move the decimal point
+    jmp .digit
+.significant:
+    inc rbx
+    cmp r12, 800
+    jae .digit_dropped
+    mov [rbp + .digits + r12], al
+    inc r12
+    jmp .digit
+.digit_dropped:
+    test al, al
+    jz .digit
+    mov r14, 1
+    jmp .digit
+.separator:
+    test r10, r10
+    jnz .failure
+    mov r10, 1
+    mov r13, rbx
+    jmp .digit
+.digit_done:
+    ; At least one digit is required.
+    test r11, r11
+    jz .failure
+    test r10, r10
+    jnz .convert
+    mov r13, rbx
+
+.convert:
+    ; bias := 1 - 2^(expbits - 1)
+    mov ecx, r9d
+    dec ecx
+    mov rax, 1
+    shl rax, cl
+    neg rax
+    inc rax
+    mov [rbp + .bias], rax
+
+    test r12, r12
+    jz .zero
+    cmp r13, 310
+    jg .infinity
+    cmp r13, -330
+    jl .zero
+
+    ; Scale by powers of two until the decimal is in the range [0.5, 1).
+    xor r10, r10
+    mov rdi, sys._ieee754_powtab
+.scale_down:
+    cmp r13, 0
+    jle .scale_up
+    mov r11, 27
+    cmp r13, sys._ieee754_powtab_count
+    jae .scale_down_by
+    movzx r11d, byte [rdi + r13]
+.scale_down_by:
+    add r10, r11
+    neg r11
+    push rdi
+    call .shift
+    pop rdi
+    jmp .scale_down
+.scale_up:
+    cmp r13, 0
+    jl .scale_up_step
+    jg .scaled
+    cmp byte [rbp + .digits], 5
+    jae .scaled
+.scale_up_step:
+    mov rax, r13
+    neg rax
+    mov r11, 27
+    cmp rax, sys._ieee754_powtab_count
+    jae .scale_up_by
+    movzx r11d, byte [rdi + rax]
+.scale_up_by:
+    sub r10, r11
+    push rdi
+    call .shift
+    pop rdi
+    jmp .scale_up
+
+.scaled:
+    ; The range [0.5, 1) corresponds to the exponent of the range [1, 2).
+    dec r10
+    ; The minimum exponent is bias + 1, with smaller values being subnormal.
+    mov rax, [rbp + .bias]
+    inc rax
+    cmp r10, rax
+    jge .normal
+    mov r11, r10
+    sub r11, rax
+    mov r10, rax
+    call .shift
+.normal:
+    call .check_overflow
+    jae .infinity
+
+    ; Extract 1 + mantbits bits.
+    lea r11, [r8 + 1]
+    call .shift
+    call .rounded_integer
+    ; Rounding may have produced 2^(1 + mantbits).
+    mov ecx, r8d
+    inc ecx
+    mov rdx, 1
+    shl rdx, cl
+    cmp rax, rdx
+    jne .subnormal
+    shr rax, 1
+    inc r10
+    call .check_overflow
+    jae .infinity
+.subnormal:
+    bt rax, r8
+    jc .biased
+    mov r10, [rbp + .bias]
+.biased:
+    sub r10, [rbp + .bias]
+    jmp .assemble
+
+.zero:
+    xor eax, eax
+    xor r10, r10
+    jmp .assemble
+
+.infinity:
+    xor eax, eax
+.saturate:
+    ; Biased exponent with every bit set.
+    mov r10, 1
+    mov ecx, r9d
+    shl r10, cl
+    dec r10
+
+.assemble:
+    ; rdx := sign | biased exponent | mantissa (without the implicit bit)
+    mov ecx, r8d
+    mov rdx, 1
+    shl rdx, cl
+    dec rdx
+    and rdx, rax
+    shl r10, cl
+    or rdx, r10
+    test r15, r15
+    jz .success
+    add ecx, r9d
+    bts rdx, rcx
+
+.success:
+    mov al, 1
+    jmp .return
+
+.failure:
+    xor eax, eax
+    jmp .return
+
+; ZF := 1 if the rcx bytes at rsi and rdi are equal
+.match:
+    push rsi
+    push rcx
+    repe cmpsb
+    pop rcx
+    pop rsi
+    ret
+
+; CF := 0 if the binary exponent does not fit in the exponent bits
+.check_overflow:
+    mov rsi, r10
+    sub rsi, [rbp + .bias]
+    mov rdx, 1
+    mov ecx, r9d
+    shl rdx, cl
+    dec rdx
+    cmp rsi, rdx
+    ret
+
+; Multiply the decimal by 2^r11 (divide if r11 is negative), leaving r11 zero.
+.shift:
+    test r12, r12
+    jz .shift_done
+    cmp r11, 0
+    je .shift_done
+    jl .shift_right
+    mov ecx, 60
+    cmp r11, rcx
+    cmovl rcx, r11
+    sub r11, rcx
+    call .left_shift
+    jmp .shift
+.shift_right:
+    mov rcx, r11
+    neg rcx
+    cmp rcx, 60
+    jbe .shift_right_by
+    mov ecx, 60
+.shift_right_by:
+    add r11, rcx
+    call .right_shift
+    jmp .shift
+.shift_done:
+    xor r11, r11
+    ret
+
+; Multiply the decimal by 2^cl with 1 <= cl <= 60.
+;
+; Digits are produced least significant first into the end of the scratch
+; buffer and then moved to the start of the digits buffer.
+.left_shift:
+    mov rdi, 832 ; scratch index, decremented before each digit
+    mov rsi, r12
+    xor eax, eax
+.left_shift_digit:
+    test rsi, rsi
+    jz .left_shift_carry
+    dec rsi
+    movzx edx, byte [rbp + .digits + rsi]
+    shl rdx, cl
+    add rax, rdx
+    call .divide_by_10
+    jmp .left_shift_digit
+.left_shift_carry:
+    test rax, rax
+    jz .left_shift_count
+    call .divide_by_10
+    jmp .left_shift_carry
+.left_shift_count:
+    ; dp := dp + (new nd - nd)
+    mov rax, 832
+    sub rax, rdi
+    sub r13, r12
+    add r13, rax
+    mov r12, rax
+    cmp r12, 800
+    jbe .left_shift_move
+    mov r12, 800
+    lea rsi, [rdi + 800]
+.left_shift_truncated:
+    cmp byte [rbp + .scratch + rsi], 0
+    je .left_shift_truncated_next
+    mov r14, 1
+.left_shift_truncated_next:
+    inc rsi
+    cmp rsi, 832
+    jb .left_shift_truncated
+.left_shift_move:
+    lea rsi, [rbp + .scratch + rdi]
+    lea rdi, [rbp + .digits]
+    mov rcx, r12
+    rep movsb
+    jmp .trim
+
+; rax := rax / 10, storing the digit rax % 10 before scratch index rdi - 1
+.divide_by_10:
+    mov rbx, rax
+    mov rdx, 0xCCCCCCCCCCCCCCCD ; ceil(2^67 / 10)
+    mul rdx
+    shr rdx, 3
+    lea rax, [rdx + rdx * 4]
+    add rax, rax
+    sub rbx, rax
+    mov rax, rdx
+    dec rdi
+    mov [rbp + .scratch + rdi], bl
+    ret
+
+; Divide the decimal by 2^cl with 1 <= cl <= 60.
+.right_shift:
+    xor esi, esi ; read index
+    xor edi, edi ; write index
+    xor eax, eax
+.right_shift_read:
+    ; Read digits until n >= 2^k.
+    mov rdx, rax
+    shr rdx, cl
+    jnz .right_shift_point
+    cmp rsi, r12
+    jae .right_shift_extend
+    imul rax, rax, 10
+    movzx edx, byte [rbp + .digits + rsi]
+    add rax, rdx
+    inc rsi
+    jmp .right_shift_read
+.right_shift_extend:
+    test rax, rax
+    jnz .right_shift_extend_digit
+    xor r12, r12
+    ret
+.right_shift_extend_digit:
+    mov rdx, rax
+    shr rdx, cl
+    jnz .right_shift_point
+    imul rax, rax, 10
+    inc rsi
+    jmp .right_shift_extend_digit
+.right_shift_point:
+    ; dp := dp - (r - 1)
+    sub r13, rsi
+    inc r13
+    mov rbx, 1
+    shl rbx, cl
+    dec rbx
+.right_shift_digit:
+    cmp rsi, r12
+    jae .right_shift_drain
+    mov rdx, rax
+    shr rdx, cl
+    and rax, rbx
+    mov [rbp + .digits + rdi], dl
+    inc rdi
+    imul rax, rax, 10
+    movzx edx, byte [rbp + .digits + rsi]
+    add rax, rdx
+    inc rsi
+    jmp .right_shift_digit
+.right_shift_drain:
+    test rax, rax
+    jz .right_shift_done
+    mov rdx, rax
+    shr rdx, cl
+    and rax, rbx
+    cmp rdi, 800
+    jae .right_shift_truncated
+    mov [rbp + .digits + rdi], dl
+    inc rdi
+    jmp .right_shift_next
+.right_shift_truncated:
+    test rdx, rdx
+    jz .right_shift_next
+    mov r14, 1
+.right_shift_next:
+    imul rax, rax, 10
+    jmp .right_shift_drain
+.right_shift_done:
+    mov r12, rdi
+
+; Remove trailing zero digits.
+.trim:
+    test r12, r12
+    jz .trim_empty
+    cmp byte [rbp + .digits + r12 - 1], 0
+    jne .trim_done
+    dec r12
+    jmp .trim
+.trim_empty:
+    xor r13, r13
+.trim_done:
+    ret
+
+; rax := the integral part of the decimal rounded half to even
+.rounded_integer:
+    xor eax, eax
+    xor esi, esi
+.rounded_integer_digit:
+    cmp rsi, r13
+    jge .rounded_integer_round
+    imul rax, rax, 10
+    cmp rsi, r12
+    jae .rounded_integer_next
+    movzx edx, byte [rbp + .digits + rsi]
+    add rax, rdx
+.rounded_integer_next:
+    inc rsi
+    jmp .rounded_integer_digit
+.rounded_integer_round:
+    cmp r13, 0
+    jl .rounded_integer_done
+    cmp r13, r12
+    jge .rounded_integer_done
+    cmp byte [rbp + .digits + r13], 5
+    jb .rounded_integer_done
+    ja .rounded_integer_up
+    ; Exactly halfway unless more digits follow.
+    lea rdx, [r13 + 1]
+    cmp rdx, r12
+    jne .rounded_integer_up
+    test r14, r14
+    jnz .rounded_integer_up
+    test al, 1
+    jz .rounded_integer_done
+.rounded_integer_up:
+    inc rax
+.rounded_integer_done:
+    ret
+
+.return:
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE sys._str_to_ieee754
+
+; SYS STR_TO_F32 SUBROUTINE
+; =========================
+; func str_to_f32(out: *f32, start: *byte, count: usize) bool
+;
+; ## Stack
+; +--------------------+ <- rbp + 0x30
+; | return value       |
+; +--------------------+ <- rbp + 0x28
+; | out                |
+; +--------------------+ <- rbp + 0x20
+; | start              |
+; +--------------------+ <- rbp + 0x18
+; | count              |
+; +--------------------+ <- rbp + 0x10
+; | return address     |
+; +--------------------+ <- rbp + 0x08
+; | saved rbp          |
+; +--------------------+ <- rbp
+section .text
+sys.str_to_f32:
+    push rbp
+    mov rbp, rsp
+
+    mov rsi, [rbp + 0x18] ; start
+    mov rcx, [rbp + 0x10] ; count
+    mov r8, 23
+    mov r9, 8
+    call sys._str_to_ieee754
+    mov [rbp + 0x28], al
+    test al, al
+    jz .return
+    mov rax, [rbp + 0x20] ; out
+    mov [rax], edx
+
+.return:
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE sys.str_to_f32
+
+; SYS STR_TO_F64 SUBROUTINE
+; =========================
+; func str_to_f64(out: *f64, start: *byte, count: usize) bool
+;
+; ## Stack
+; +--------------------+ <- rbp + 0x30
+; | return value       |
+; +--------------------+ <- rbp + 0x28
+; | out                |
+; +--------------------+ <- rbp + 0x20
+; | start              |
+; +--------------------+ <- rbp + 0x18
+; | count              |
+; +--------------------+ <- rbp + 0x10
+; | return address     |
+; +--------------------+ <- rbp + 0x08
+; | saved rbp          |
+; +--------------------+ <- rbp
+section .text
+sys.str_to_f64:
+    push rbp
+    mov rbp, rsp
+
+    mov rsi, [rbp + 0x18] ; start
+    mov rcx, [rbp + 0x10] ; count
+    mov r8, 52
+    mov r9, 11
+    call sys._str_to_ieee754
+    mov [rbp + 0x28], al
+    test al, al
+    jz .return
+    mov rax, [rbp + 0x20] ; out
+    mov [rax], rdx
+
+.return:
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE sys.str_to_f64
+
+; SYS F32_TO_STR SUBROUTINE
+; =========================
+; func f32_to_str(buf: *byte, buf_size: usize, f: f32, digits: ssize) bool
+;
+; Widens f to f64 (exactly) and defers to sys.f64_to_str, using
+; FLT_DECIMAL_DIG fractional digits if digits is negative.
+;
+; ## Stack
+; +--------------------+ <- rbp + 0x38
+; | return value       |
+; +--------------------+ <- rbp + 0x30
+; | buf                |
+; +--------------------+ <- rbp + 0x28
+; | buf_size           |
+; +--------------------+ <- rbp + 0x20
+; | f                  |
+; +--------------------+ <- rbp + 0x18
+; | digits             |
+; +--------------------+ <- rbp + 0x10
+; | return address     |
+; +--------------------+ <- rbp + 0x08
+; | saved rbp          |
+; +--------------------+ <- rbp
 section .text
-sys.str_to_f32: call __fatal_unimplemented
-sys.str_to_f64: call __fatal_unimplemented
-
-sys.f32_to_str: call __fatal_unimplemented
-sys.f64_to_str: call __fatal_unimplemented
-
-sys.f32_abs: call __fatal_unimplemented
-sys.f64_abs: call __fatal_unimplemented
-sys.f32_min: call __fatal_unimplemented
-sys.f64_min: call __fatal_unimplemented
-sys.f32_max: call __fatal_unimplemented
-sys.f64_max: call __fatal_unimplemented
-
-sys.f32_ln: call __fatal_unimplemented
-sys.f64_ln: call __fatal_unimplemented
-sys.f32_log2: call __fatal_unimplemented
-sys.f64_log2: call __fatal_unimplemented
-sys.f32_log10: call __fatal_unimplemented
-sys.f64_log10: call __fatal_unimplemented
-
-sys.f32_sqrt: call __fatal_unimplemented
-sys.f64_sqrt: call __fatal_unimplemented
-sys.f32_cbrt: call __fatal_unimplemented
-sys.f64_cbrt: call __fatal_unimplemented
-sys.f32_hypot: call __fatal_unimplemented
-sys.f64_hypot: call __fatal_unimplemented
-sys.f32_pow: call __fatal_unimplemented
-sys.f64_pow: call __fatal_unimplemented
-
-sys.f32_sin: call __fatal_unimplemented
-sys.f64_sin: call __fatal_unimplemented
-sys.f32_cos: call __fatal_unimplemented
-sys.f64_cos: call __fatal_unimplemented
-sys.f32_tan: call __fatal_unimplemented
-sys.f64_tan: call __fatal_unimplemented
-sys.f32_asin: call __fatal_unimplemented
-sys.f64_asin: call __fatal_unimplemented
-sys.f32_acos: call __fatal_unimplemented
-sys.f64_acos: call __fatal_unimplemented
-sys.f32_atan: call __fatal_unimplemented
-sys.f64_atan: call __fatal_unimplemented
-sys.f32_atan2: call __fatal_unimplemented
-sys.f64_atan2: call __fatal_unimplemented
-
-sys.f32_sinh: call __fatal_unimplemented
-sys.f64_sinh: call __fatal_unimplemented
-sys.f32_cosh: call __fatal_unimplemented
-sys.f64_cosh: call __fatal_unimplemented
-sys.f32_tanh: call __fatal_unimplemented
-sys.f64_tanh: call __fatal_unimplemented
-sys.f32_asinh: call __fatal_unimplemented
-sys.f64_asinh: call __fatal_unimplemented
-sys.f32_acosh: call __fatal_unimplemented
-sys.f64_acosh: call __fatal_unimplemented
-sys.f32_atanh: call __fatal_unimplemented
-sys.f64_atanh: call __fatal_unimplemented
-
-sys.f32_ceil: call __fatal_unimplemented
-sys.f64_ceil: call __fatal_unimplemented
-sys.f32_floor: call __fatal_unimplemented
-sys.f64_floor: call __fatal_unimplemented
-sys.f32_trunc: call __fatal_unimplemented
-sys.f64_trunc: call __fatal_unimplemented
-sys.f32_round: call __fatal_unimplemented
-sys.f64_round: call __fatal_unimplemented
-
-sys.f32_is_finite: call __fatal_unimplemented
-sys.f64_is_finite: call __fatal_unimplemented
-sys.f32_is_normal: call __fatal_unimplemented
-sys.f64_is_normal: call __fatal_unimplemented
-sys.f32_is_inf: call __fatal_unimplemented
-sys.f64_is_inf: call __fatal_unimplemented
-sys.f32_is_nan: call __fatal_unimplemented
-sys.f64_is_nan: call __fatal_unimplemented
+sys.f32_to_str:
+    push rbp
+    mov rbp, rsp
+
+    mov r8, [rbp + 0x10] ; digits
+    cmp r8, 0
+    jge .call
+    mov r8, 9 ; FLT_DECIMAL_DIG
+
+.call:
+    cvtss2sd xmm0, [rbp + 0x18]
+    sub rsp, 0x8          ; return value
+    push qword [rbp + 0x28] ; buf
+    push qword [rbp + 0x20] ; buf_size
+    sub rsp, 0x8
+    movsd [rsp], xmm0     ; f
+    push r8               ; digits
+    call sys.f64_to_str
+    add rsp, 0x20
+    pop rax
+    mov [rbp + 0x30], al
+
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE sys.f32_to_str
+
+; SYS F64_TO_STR SUBROUTINE
+; =========================
+; func f64_to_str(buf: *byte, buf_size: usize, f: f64, digits: ssize) bool
+;
+; Writes the NUL-terminated decimal representation of f with the provided
+; number of fractional digits (DBL_DECIMAL_DIG if digits is negative) into
+; buf. The conversion is exact and rounds half to even, producing the same
+; output as printf("%.*f", digits, f). Returns false if buf is too small.
+;
+; With |f| = m * 2^e, the integral part is expanded into 32-bit limbs and
+; repeatedly divided by 10^9. The fractional part m mod 2^k (with k = -e) is
+; repeatedly multiplied by ten, with each digit being the bits above bit k.
+;
+; ## Stack
+; +--------------------+ <- rbp + 0x38
+; | return value       |
+; +--------------------+ <- rbp + 0x30
+; | buf                |
+; +--------------------+ <- rbp + 0x28
+; | buf_size           |
+; +--------------------+ <- rbp + 0x20
+; | f                  |
+; +--------------------+ <- rbp + 0x18
+; | digits             |
+; +--------------------+ <- rbp + 0x10
+; | return address     |
+; +--------------------+ <- rbp + 0x08
+; | saved rbp          |
+; +--------------------+ <- rbp
+; | limbs (36 * u32)   |
+; +--------------------+ <- rbp - 0x90
+; | integral digits    |
+; +--------------------+ <- rbp - 0x1D0
+;
+; ## Registers
+; r8  := remaining fractional digits
+; r9  := bits of f (scratch after decomposition)
+; r10 := buf_ptr
+; r11 := buf_end
+; r12 := mantissa
+; r13 := binary exponent, then k (number of fractional bits)
+; r14 := limb count
+; r15 := start of the integral digits within buf
+section .text
+sys.f64_to_str:
+    push rbp
+    mov rbp, rsp
+    sub rsp, 0x1D0
+
+.limbs      equ -0x90
+.digits_end equ -0x90
+
+    mov r10, [rbp + 0x28] ; buf
+    mov r11, r10
+    add r11, [rbp + 0x20] ; buf + buf_size
+    mov r9, [rbp + 0x18]  ; f
+    mov r8, [rbp + 0x10]  ; digits
+    cmp r8, 0
+    jge .classify
+    mov r8, 17 ; DBL_DECIMAL_DIG
+
+.classify:
+    mov rax, r9
+    btr rax, 63
+    mov rbx, 0x7FF0000000000000
+    cmp rax, rbx
+    jb .finite
+    ja .nan
+    mov rsi, sys._ieee754_str_ninf_start
+    mov rcx, sys._ieee754_str_ninf_count
+    bt r9, 63
+    jc .special
+    inc rsi ; skip the '-' of "-infinity"
+    dec rcx
+    jmp .special
+.nan:
+    mov rsi, sys._ieee754_str_nan_start
+    mov rcx, sys._ieee754_str_nan_count
+.special:
+    mov rax, r11
+    sub rax, r10
+    cmp rcx, rax
+    jae .failure
+    mov rdi, r10
+    rep movsb
+    mov r10, rdi
+    jmp .terminate
+
+.finite:
+    bt r9, 63
+    jnc .decompose
+    cmp r10, r11
+    jae .failure
+    mov byte [r10], '-'
+    inc r10
+
+.decompose:
+    ; |f| = r12 * 2^r13
+    mov r12, r9
+    mov rax, 0x000FFFFFFFFFFFFF
+    and r12, rax
+    mov r13, r9
+    shr r13, 52
+    and r13, 0x7FF
+    jz .subnormal
+    bts r12, 52
+    sub r13, 1075
+    jmp .integral
+.subnormal:
+    mov r13, -1074
+
+.integral:
+    lea rdi, [rbp + .limbs]
+    xor eax, eax
+    mov rcx, 36
+    rep stosd
+
+    lea rdi, [rbp + .limbs]
+    cmp r13, 0
+    jl .integral_shift_right
+    ; limbs := mantissa << exponent
+    mov rcx, r13
+    and rcx, 31
+    mov rax, r12
+    xor rdx, rdx
+    shld rdx, rax, cl
+    shl rax, cl
+    mov rbx, r13
+    shr rbx, 5
+    mov [rdi + rbx*4], rax
+    mov [rdi + rbx*4 + 8], rdx
+    lea r14, [rbx + 4]
+    jmp .integral_digits
+.integral_shift_right:
+    ; limbs := mantissa >> -exponent
+    mov rcx, r13
+    neg rcx
+    xor eax, eax
+    cmp rcx, 64
+    jae .integral_store
+    mov rax, r12
+    shr rax, cl
+.integral_store:
+    mov [rdi], rax
+    mov r14, 2
+
+.integral_digits:
+    ; Integral digits are written backwards ending at .digits_end in chunks
+    ; of nine digits.
+    lea rsi, [rbp + .digits_end]
+    mov ebx, 1000000000
+.integral_chunk:
+    test r14, r14
+    jz .integral_strip
+    cmp dword [rdi + r14*4 - 4], 0
+    jne .integral_divide
+    dec r14
+    jmp .integral_chunk
+.integral_divide:
+    ; limbs := limbs / 10^9, edx := limbs % 10^9
+    mov rcx, r14
+    xor edx, edx
+.integral_divide_limb:
+    mov eax, [rdi + rcx*4 - 4]
+    div ebx
+    mov [rdi + rcx*4 - 4], eax
+    dec rcx
+    jnz .integral_divide_limb
+    mov eax, edx
+    mov rcx, 9
+    mov r9d, 10
+.integral_emit:
+    xor edx, edx
+    div r9d
+    add dl, '0'
+    dec rsi
+    mov [rsi], dl
+    dec rcx
+    jnz .integral_emit
+    jmp .integral_chunk
+
+.integral_strip:
+    ; Strip leading zeros, keeping at least one digit.
+    lea rcx, [rbp + .digits_end]
+.integral_strip_zero:
+    cmp rsi, rcx
+    je .integral_zero
+    cmp byte [rsi], '0'
+    jne .integral_write
+    inc rsi
+    jmp .integral_strip_zero
+.integral_zero:
+    dec rsi
+    mov byte [rsi], '0'
+.integral_write:
+    mov r15, r10
+    sub rcx, rsi
+    mov rax, r11
+    sub rax, r10
+    cmp rcx, rax
+    jae .failure
+    mov rdi, r10
+    rep movsb
+    mov r10, rdi
+
+.fractional:
+    lea rdi, [rbp + .limbs]
+    xor eax, eax
+    mov rcx, 36
+    rep stosd
+
+    ; r13 := k, zero if f is integral
+    neg r13
+    cmp r13, 0
+    jg .fractional_value
+    xor r13, r13
+    jmp .fractional_limbs
+.fractional_value:
+    ; limbs := mantissa mod 2^k
+    mov rax, r12
+    cmp r13, 64
+    jae .fractional_store
+    mov rcx, r13
+    mov rdx, 1
+    shl rdx, cl
+    dec rdx
+    and rax, rdx
+.fractional_store:
+    mov [rbp + .limbs], rax
+.fractional_limbs:
+    mov r14, r13
+    shr r14, 5
+    add r14, 2
+
+    test r8, r8
+    jz .round
+    cmp r10, r11
+    jae .failure
+    mov byte [r10], '.'
+    inc r10
+    mov rbx, 10
+.fractional_digit:
+    cmp r10, r11
+    jae .failure
+    call .multiply_extract
+    add al, '0'
+    mov [r10], al
+    inc r10
+    dec r8
+    jnz .fractional_digit
+
+.round:
+    ; Round up if the remaining fraction is greater than one half, or equal to
+    ; one half and the last digit is odd.
+    mov rbx, 2
+    call .multiply_extract
+    test rax, rax
+    jz .terminate
+    lea rdi, [rbp + .limbs]
+    mov rcx, r14
+.round_tie:
+    cmp dword [rdi + rcx*4 - 4], 0
+    jne .round_up
+    dec rcx
+    jnz .round_tie
+    mov rax, r10
+    test byte [rax - 1], 1 ; the parity of '0'..'9' matches the digit
+    jz .terminate
+.round_up:
+    mov rax, r10
+.round_carry:
+    cmp rax, r15
+    je .round_overflow
+    dec rax
+    cmp byte [rax], '.'
+    je .round_carry
+    cmp byte [rax], '9'
+    jne .round_increment
+    mov byte [rax], '0'
+    jmp .round_carry
+.round_increment:
+    inc byte [rax]
+    jmp .terminate
+.round_overflow:
+    ; Every digit was a nine, so shift the digits right and prepend a one.
+    cmp r10, r11
+    jae .failure
+    lea rsi, [r10 - 1]
+    mov rdi, r10
+    mov rcx, r10
+    sub rcx, r15
+    std
+    rep movsb
+    cld
+    mov byte [r15], '1'
+    inc r10
+    jmp .terminate
+
+; limbs := limbs * rbx, rax := limbs >> k, limbs := limbs mod 2^k
+.multiply_extract:
+    lea rdi, [rbp + .limbs]
+    xor ecx, ecx
+    xor esi, esi
+.multiply_limb:
+    mov eax, [rdi + rcx*4]
+    imul rax, rbx
+    add rax, rsi
+    mov [rdi + rcx*4], eax
+    shr rax, 32
+    mov rsi, rax
+    inc rcx
+    cmp rcx, r14
+    jb .multiply_limb
+    mov r9, r13
+    shr r9, 5
+    mov rcx, r13
+    and rcx, 31
+    mov rax, [rdi + r9*4]
+    mov rdx, 1
+    shl rdx, cl
+    dec rdx
+    mov rsi, rax
+    and rsi, rdx
+    mov [rdi + r9*4], rsi
+    shr rax, cl
+    ret
+
+.terminate:
+    cmp r10, r11
+    jae .failure
+    mov byte [r10], 0x00
+    mov byte [rbp + 0x30], 0x01
+    jmp .return
+
+.failure:
+    mov byte [rbp + 0x30], 0x00
+
+.return:
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE sys.f64_to_str
+
+; SYS IEEE-754 MATH FUNCTIONS
+; ===========================
+section .text
+sys.f32_abs:
+    __SYS_IEEE754_ABS eax, 31
+    __SYS_EH_FRAME_FDE sys.f32_abs
+sys.f64_abs:
+    __SYS_IEEE754_ABS rax, 63
+    __SYS_EH_FRAME_FDE sys.f64_abs
+sys.f32_min:
+    __SYS_IEEE754_MINMAX ss, minss, 22
+    __SYS_EH_FRAME_FDE sys.f32_min
+sys.f64_min:
+    __SYS_IEEE754_MINMAX sd, minsd, 51
+    __SYS_EH_FRAME_FDE sys.f64_min
+sys.f32_max:
+    __SYS_IEEE754_MINMAX ss, maxss, 22
+    __SYS_EH_FRAME_FDE sys.f32_max
+sys.f64_max:
+    __SYS_IEEE754_MINMAX sd, maxsd, 51
+    __SYS_EH_FRAME_FDE sys.f64_max
+
+section .text
+sys.f32_ln:
+    __SYS_IEEE754_X87_UNARY dword, __x87_ln
+    __SYS_EH_FRAME_FDE sys.f32_ln
+sys.f64_ln:
+    __SYS_IEEE754_X87_UNARY qword, __x87_ln
+    __SYS_EH_FRAME_FDE sys.f64_ln
+sys.f32_log2:
+    __SYS_IEEE754_X87_UNARY dword, __x87_log2
+    __SYS_EH_FRAME_FDE sys.f32_log2
+sys.f64_log2:
+    __SYS_IEEE754_X87_UNARY qword, __x87_log2
+    __SYS_EH_FRAME_FDE sys.f64_log2
+sys.f32_log10:
+    __SYS_IEEE754_X87_UNARY dword, __x87_log10
+    __SYS_EH_FRAME_FDE sys.f32_log10
+sys.f64_log10:
+    __SYS_IEEE754_X87_UNARY qword, __x87_log10
+    __SYS_EH_FRAME_FDE sys.f64_log10
+
+section .text
+sys.f32_sqrt:
+    __SYS_IEEE754_SQRT ss
+    __SYS_EH_FRAME_FDE sys.f32_sqrt
+sys.f64_sqrt:
+    __SYS_IEEE754_SQRT sd
+    __SYS_EH_FRAME_FDE sys.f64_sqrt
+sys.f32_cbrt:
+    __SYS_IEEE754_X87_UNARY dword, __x87_cbrt
+    __SYS_EH_FRAME_FDE sys.f32_cbrt
+sys.f64_cbrt:
+    __SYS_IEEE754_X87_UNARY qword, __x87_cbrt
+    __SYS_EH_FRAME_FDE sys.f64_cbrt
+sys.f32_hypot:
+    __SYS_IEEE754_X87_BINARY dword, __x87_hypot
+    __SYS_EH_FRAME_FDE sys.f32_hypot
+sys.f64_hypot:
+    __SYS_IEEE754_X87_BINARY qword, __x87_hypot
+    __SYS_EH_FRAME_FDE sys.f64_hypot
+sys.f32_pow:
+    __SYS_IEEE754_X87_BINARY dword, __x87_pow
+    __SYS_EH_FRAME_FDE sys.f32_pow
+sys.f64_pow:
+    __SYS_IEEE754_X87_BINARY qword, __x87_pow
+    __SYS_EH_FRAME_FDE sys.f64_pow
+
+section .text
+sys.f32_sin:
+    __SYS_IEEE754_X87_UNARY dword, __x87_sin
+    __SYS_EH_FRAME_FDE sys.f32_sin
+sys.f64_sin:
+    __SYS_IEEE754_X87_UNARY qword, __x87_sin
+    __SYS_EH_FRAME_FDE sys.f64_sin
+sys.f32_cos:
+    __SYS_IEEE754_X87_UNARY dword, __x87_cos
+    __SYS_EH_FRAME_FDE sys.f32_cos
+sys.f64_cos:
+    __SYS_IEEE754_X87_UNARY qword, __x87_cos
+    __SYS_EH_FRAME_FDE sys.f64_cos
+sys.f32_tan:
+    __SYS_IEEE754_X87_UNARY dword, __x87_tan
+    __SYS_EH_FRAME_FDE sys.f32_tan
+sys.f64_tan:
+    __SYS_IEEE754_X87_UNARY qword, __x87_tan
+    __SYS_EH_FRAME_FDE sys.f64_tan
+sys.f32_asin:
+    __SYS_IEEE754_X87_UNARY dword, __x87_asin
+    __SYS_EH_FRAME_FDE sys.f32_asin
+sys.f64_asin:
+    __SYS_IEEE754_X87_UNARY qword, __x87_asin
+    __SYS_EH_FRAME_FDE sys.f64_asin
+sys.f32_acos:
+    __SYS_IEEE754_X87_UNARY dword, __x87_acos
+    __SYS_EH_FRAME_FDE sys.f32_acos
+sys.f64_acos:
+    __SYS_IEEE754_X87_UNARY qword, __x87_acos
+    __SYS_EH_FRAME_FDE sys.f64_acos
+sys.f32_atan:
+    __SYS_IEEE754_X87_UNARY dword, __x87_atan
+    __SYS_EH_FRAME_FDE sys.f32_atan
+sys.f64_atan:
+    __SYS_IEEE754_X87_UNARY qword, __x87_atan
+    __SYS_EH_FRAME_FDE sys.f64_atan
+sys.f32_atan2:
+    __SYS_IEEE754_X87_BINARY dword, __x87_atan2
+    __SYS_EH_FRAME_FDE sys.f32_atan2
+sys.f64_atan2:
+    __SYS_IEEE754_X87_BINARY qword, __x87_atan2
+    __SYS_EH_FRAME_FDE sys.f64_atan2
+
+section .text
+sys.f32_sinh:
+    __SYS_IEEE754_X87_UNARY dword, __x87_sinh
+    __SYS_EH_FRAME_FDE sys.f32_sinh
+sys.f64_sinh:
+    __SYS_IEEE754_X87_UNARY qword, __x87_sinh
+    __SYS_EH_FRAME_FDE sys.f64_sinh
+sys.f32_cosh:
+    __SYS_IEEE754_X87_UNARY dword, __x87_cosh
+    __SYS_EH_FRAME_FDE sys.f32_cosh
+sys.f64_cosh:
+    __SYS_IEEE754_X87_UNARY qword, __x87_cosh
+    __SYS_EH_FRAME_FDE sys.f64_cosh
+sys.f32_tanh:
+    __SYS_IEEE754_X87_UNARY dword, __x87_tanh
+    __SYS_EH_FRAME_FDE sys.f32_tanh
+sys.f64_tanh:
+    __SYS_IEEE754_X87_UNARY qword, __x87_tanh
+    __SYS_EH_FRAME_FDE sys.f64_tanh
+sys.f32_asinh:
+    __SYS_IEEE754_X87_UNARY dword, __x87_asinh
+    __SYS_EH_FRAME_FDE sys.f32_asinh
+sys.f64_asinh:
+    __SYS_IEEE754_X87_UNARY qword, __x87_asinh
+    __SYS_EH_FRAME_FDE sys.f64_asinh
+sys.f32_acosh:
+    __SYS_IEEE754_X87_UNARY dword, __x87_acosh
+    __SYS_EH_FRAME_FDE sys.f32_acosh
+sys.f64_acosh:
+    __SYS_IEEE754_X87_UNARY qword, __x87_acosh
+    __SYS_EH_FRAME_FDE sys.f64_acosh
+sys.f32_atanh:
+    __SYS_IEEE754_X87_UNARY dword, __x87_atanh
+    __SYS_EH_FRAME_FDE sys.f32_atanh
+sys.f64_atanh:
+    __SYS_IEEE754_X87_UNARY qword, __x87_atanh
+    __SYS_EH_FRAME_FDE sys.f64_atanh
+
+section .text
+sys.f32_ceil:
+    __SYS_IEEE754_ROUNDING ss, __ROUND_CEIL
+    __SYS_EH_FRAME_FDE sys.f32_ceil
+sys.f64_ceil:
+    __SYS_IEEE754_ROUNDING sd, __ROUND_CEIL
+    __SYS_EH_FRAME_FDE sys.f64_ceil
+sys.f32_floor:
+    __SYS_IEEE754_ROUNDING ss, __ROUND_FLOOR
+    __SYS_EH_FRAME_FDE sys.f32_floor
+sys.f64_floor:
+    __SYS_IEEE754_ROUNDING sd, __ROUND_FLOOR
+    __SYS_EH_FRAME_FDE sys.f64_floor
+sys.f32_trunc:
+    __SYS_IEEE754_ROUNDING ss, __ROUND_TRUNC
+    __SYS_EH_FRAME_FDE sys.f32_trunc
+sys.f64_trunc:
+    __SYS_IEEE754_ROUNDING sd, __ROUND_TRUNC
+    __SYS_EH_FRAME_FDE sys.f64_trunc
+sys.f32_round:
+    __SYS_IEEE754_ROUND ss, sys._ieee754_f32_round_bias, 3
+    __SYS_EH_FRAME_FDE sys.f32_round
+sys.f64_round:
+    __SYS_IEEE754_ROUND sd, sys._ieee754_f64_round_bias, 7
+    __SYS_EH_FRAME_FDE sys.f64_round
+
+section .text
+sys.f32_is_finite:
+    __SYS_IEEE754_CLASSIFY eax, ebx, 0x7FFFFFFF, 0x7F800000, b
+    __SYS_EH_FRAME_FDE sys.f32_is_finite
+sys.f64_is_finite:
+    __SYS_IEEE754_CLASSIFY rax, rbx, 0x7FFFFFFFFFFFFFFF, 0x7FF0000000000000, b
+    __SYS_EH_FRAME_FDE sys.f64_is_finite
+sys.f32_is_normal:
+    __SYS_IEEE754_IS_NORMAL eax, ebx, 0x7FFFFFFF, 0x7F800000, 0x00800000
+    __SYS_EH_FRAME_FDE sys.f32_is_normal
+sys.f64_is_normal:
+    __SYS_IEEE754_IS_NORMAL rax, rbx, 0x7FFFFFFFFFFFFFFF, 0x7FF0000000000000, 0x0010000000000000
+    __SYS_EH_FRAME_FDE sys.f64_is_normal
+sys.f32_is_inf:
+    __SYS_IEEE754_CLASSIFY eax, ebx, 0x7FFFFFFF, 0x7F800000, e
+    __SYS_EH_FRAME_FDE sys.f32_is_inf
+sys.f64_is_inf:
+    __SYS_IEEE754_CLASSIFY rax, rbx, 0x7FFFFFFFFFFFFFFF, 0x7FF0000000000000, e
+    __SYS_EH_FRAME_FDE sys.f64_is_inf
+sys.f32_is_nan:
+    __SYS_IEEE754_CLASSIFY eax, ebx, 0x7FFFFFFF, 0x7F800000, a
+    __SYS_EH_FRAME_FDE sys.f32_is_nan
+sys.f64_is_nan:
+    __SYS_IEEE754_CLASSIFY rax, rbx, 0x7FFFFFFFFFFFFFFF, 0x7FF0000000000000, a
+    __SYS_EH_FRAME_FDE sys.f64_is_nan
+
+; BUILTIN PROFILER SUBROUTINES
+; ============================
+; Function-level instrumentation profiler enabled with `sunder-compile -p`.
+;
+; Every instrumented function owns a profile record in the .data section and
+; reserves a profile frame at the bottom of its local stack space. The function
+; calls __profile_enter with its frame in rdi and its record in rsi after its
+; prologue, and calls __profile_leave with its frame in rdi before each of its
+; epilogues. The records, frames, caller/callee edges, and profile file format
+; are those of the C backend profiler in sys.h. Inclusive time of a function
+; and of the caller/callee edges into that function is only accumulated by the
+; outermost activation of the function so that recursive calls are not counted
+; more than once.
+;
+; These subroutines take their arguments in registers rather than on the
+; stack, and clobber rax, rcx, rdx, rsi, rdi, r8, r9, r10, and r11.
+;
+; ## Profile Record
+; +--------------------+ <- record + 0x40
+; | next               |
+; +--------------------+ <- record + 0x38
+; | active             |
+; +--------------------+ <- record + 0x30
+; | self_ns            |
+; +--------------------+ <- record + 0x28
+; | inclusive_ns       |
+; +--------------------+ <- record + 0x20
+; | calls              |
+; +--------------------+ <- record + 0x18
+; | id                 | (zero until the function is first called)
+; +--------------------+ <- record + 0x10
+; | name_count         |
+; +--------------------+ <- record + 0x08
+; | name_start         |
+; +--------------------+ <- record
+;
+; ## Profile Frame
+; +--------------------+ <- frame + 0x20
+; | children_ns        |
+; +--------------------+ <- frame + 0x18
+; | start_ns           |
+; +--------------------+ <- frame + 0x10
+; | parent             |
+; +--------------------+ <- frame + 0x08
+; | function           |
+; +--------------------+ <- frame
+;
+; ## Caller/Callee Edge
+; +--------------------+ <- edge + 0x20
+; | inclusive_ns       |
+; +--------------------+ <- edge + 0x18
+; | calls              |
+; +--------------------+ <- edge + 0x10
+; | callee             |
+; +--------------------+ <- edge + 0x08
+; | caller             | (zero for the program entry)
+; +--------------------+ <- edge
+%ifdef __profile
+__SYS_CLOCK_GETTIME: equ 228
+__CLOCK_MONOTONIC:   equ 1
+
+__O_WRONLY: equ 0x001
+__O_CREAT:  equ 0x040
+__O_TRUNC:  equ 0x200
+
+; Power of two number of distinct caller/callee edges that may be recorded.
+; Edges beyond this limit are counted as dropped.
+__PROFILE_EDGE_COUNT:  equ 65536
+__PROFILE_EDGE_SIZE:   equ 0x20
+__PROFILE_BUFFER_SIZE: equ 4096
+
+section .data
+__profile_functions: dq 0 ; Most recently first called function.
+__profile_function_count: dq 0
+__profile_top: dq 0 ; Innermost active frame.
+__profile_dropped_edges: dq 0
+__profile_fd: dq 0
+__profile_buffer_count: dq 0
+
+section .bss
+__profile_edges: resb __PROFILE_EDGE_COUNT * __PROFILE_EDGE_SIZE
+__profile_buffer: resb __PROFILE_BUFFER_SIZE
+
+section .rodata
+__profile_env_start: db "SUNDER_PROFILE="
+__profile_env_count: equ $ - __profile_env_start
+__profile_default_path: db "sunder.prof", 0x00
+__profile_header_start: db "# sunder-profile", 0x0A
+__profile_header_count: equ $ - __profile_header_start
+__profile_function_tag_start: db "function"
+__profile_function_tag_count: equ $ - __profile_function_tag_start
+__profile_call_tag_start: db "call"
+__profile_call_tag_count: equ $ - __profile_call_tag_start
+__profile_dropped_tag_start: db "dropped"
+__profile_dropped_tag_count: equ $ - __profile_dropped_tag_start
+__profile_error_start: db ": unable to open profile", 0x0A
+__profile_error_count: equ $ - __profile_error_start
+
+; Returns the time of the monotonic clock in nanoseconds in rax.
+section .text
+__profile_now:
+    push rbp
+    mov rbp, rsp
+    sub rsp, 0x10 ; struct timespec
+
+    mov rax, __SYS_CLOCK_GETTIME
+    mov rdi, __CLOCK_MONOTONIC
+    mov rsi, rsp
+    syscall
+    mov rax, [rsp] ; tv_sec
+    mov rcx, 1000000000
+    mul rcx
+    add rax, [rsp + 0x08] ; tv_nsec
+
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE __profile_now
+
+; Enter the function with the profile record in rsi using the profile frame
+; in rdi.
+section .text
+__profile_enter:
+    push rbp
+    mov rbp, rsp
+
+    cmp qword [rsi + 0x10], 0 ; id
+    jne .called
+    mov rax, [__profile_function_count]
+    inc rax
+    mov [__profile_function_count], rax
+    mov [rsi + 0x10], rax ; id
+    mov rax, [__profile_functions]
+    mov [rsi + 0x38], rax ; next
+    mov [__profile_functions], rsi
+.called:
+    inc qword [rsi + 0x18] ; calls
+    inc qword [rsi + 0x30] ; active
+
+    mov [rdi], rsi ; function
+    mov rax, [__profile_top]
+    mov [rdi + 0x08], rax ; parent
+    mov qword [rdi + 0x18], 0 ; children_ns
+    mov [__profile_top], rdi
+    mov r8, rdi
+    call __profile_now
+    mov [r8 + 0x10], rax ; start_ns
+
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE __profile_enter
+
+; Leave the function that was entered using the profile frame in rdi.
+section .text
+__profile_leave:
+    push rbp
+    mov rbp, rsp
+
+    mov r8, rdi ; frame
+    call __profile_now
+    sub rax, [r8 + 0x10] ; elapsed_ns = now - start_ns
+    mov r9, [r8] ; function
+
+    mov rdx, 0 ; inclusive_ns
+    dec qword [r9 + 0x30] ; active
+    cmovz rdx, rax
+    add [r9 + 0x20], rdx ; inclusive_ns
+    mov rcx, rax
+    sub rcx, [r8 + 0x18] ; children_ns
+    add [r9 + 0x28], rcx ; self_ns
+
+    mov r10, [r8 + 0x08] ; parent
+    mov [__profile_top], r10
+    mov rdi, 0 ; caller
+    cmp r10, 0
+    je .record
+    add [r10 + 0x18], rax ; children_ns
+    mov rdi, [r10] ; caller
+.record:
+    mov rsi, r9 ; callee
+    call __profile_record_edge
+
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE __profile_leave
+
+; Add a call taking rdx nanoseconds along the edge from the caller record in
+; rdi to the callee record in rsi.
+section .text
+__profile_record_edge:
+    push rbp
+    mov rbp, rsp
+
+    mov r10, rdx ; elapsed_ns
+    mov rax, rdi
+    mov rcx, 31
+    mul rcx ; clobbers rdx
+    xor rax, rsi
+    mov rcx, rax
+    shr rcx, 17
+    xor rax, rcx
+    and rax, __PROFILE_EDGE_COUNT - 1 ; index
+
+    mov r8, __PROFILE_EDGE_COUNT ; remaining probes
+    lea r9, [__profile_edges]
+.loop:
+    mov rcx, rax
+    shl rcx, 5 ; index * __PROFILE_EDGE_SIZE
+    add rcx, r9
+    cmp qword [rcx + 0x08], 0 ; callee
+    jne .compare
+    mov [rcx], rdi ; caller
+    mov [rcx + 0x08], rsi ; callee
+.compare:
+    cmp [rcx], rdi
+    jne .next
+    cmp [rcx + 0x08], rsi
+    jne .next
+    inc qword [rcx + 0x10] ; calls
+    add [rcx + 0x18], r10 ; inclusive_ns
+    jmp .return
+.next:
+    inc rax
+    and rax, __PROFILE_EDGE_COUNT - 1
+    dec r8
+    jnz .loop
+    inc qword [__profile_dropped_edges]
+
+.return:
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE __profile_record_edge
+
+; Append rdx bytes starting at rsi to the profile buffer, flushing the buffer
+; to the profile file when it is full.
+section .text
+__profile_put:
+    push rbp
+    mov rbp, rsp
+
+.loop:
+    cmp rdx, 0
+    je .return
+    mov rcx, [__profile_buffer_count]
+    cmp rcx, __PROFILE_BUFFER_SIZE
+    jb .store
+    push rsi
+    push rdx
+    call __profile_flush
+    pop rdx
+    pop rsi
+    mov rcx, 0
+.store:
+    mov al, [rsi]
+    lea rdi, [__profile_buffer]
+    mov [rdi + rcx], al
+    inc rcx
+    mov [__profile_buffer_count], rcx
+    inc rsi
+    dec rdx
+    jmp .loop
+
+.return:
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE __profile_put
+
+; Append the byte in al to the profile buffer.
+section .text
+__profile_put_byte:
+    push rbp
+    mov rbp, rsp
+    sub rsp, 0x10
+
+    mov [rsp], al
+    mov rsi, rsp
+    mov rdx, 1
+    call __profile_put
+
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE __profile_put_byte
+
+; Append the decimal representation of the unsigned integer in rax followed
+; by the byte in bl to the profile buffer.
+section .text
+__profile_put_u64:
+    push rbp
+    mov rbp, rsp
+    sub rsp, 0x20 ; at most 20 digits and the trailing byte
+
+    mov [rbp - 0x01], bl
+    lea rsi, [rbp - 0x01]
+    mov rcx, 10
+.loop:
+    mov rdx, 0
+    div rcx
+    add dl, '0'
+    dec rsi
+    mov [rsi], dl
+    cmp rax, 0
+    jne .loop
+    mov rdx, rbp
+    sub rdx, rsi
+    call __profile_put
+
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE __profile_put_u64
+
+; Write the contents of the profile buffer to the profile file.
+section .text
+__profile_flush:
+    push rbp
+    mov rbp, rsp
+
+    mov rax, __SYS_WRITE
+    mov rdi, [__profile_fd]
+    lea rsi, [__profile_buffer]
+    mov rdx, [__profile_buffer_count]
+    syscall
+    mov qword [__profile_buffer_count], 0
+
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE __profile_flush
+
+; Write the profile to the file named by the SUNDER_PROFILE environment
+; variable, or to `sunder.prof` in the current working directory. Functions
+; still executing, such as those on the call stack of an explicit exit, are
+; accounted for as if they returned at the time of the write. Preserves all
+; registers other than those clobbered by the other profiler subroutines.
+section .text
+__profile_write:
+    push rbp
+    mov rbp, rsp
+    push rbx
+    push r12
+    push r13
+
+.unwind:
+    mov rdi, [__profile_top]
+    cmp rdi, 0
+    je .path
+    call __profile_leave
+    jmp .unwind
+
+.path:
+    lea r12, [__profile_default_path]
+    mov r13, [sys.envp]
+.path_loop:
+    mov rsi, [r13]
+    cmp rsi, 0
+    je .open
+    add r13, 0x08
+    lea rdi, [__profile_env_start]
+    mov rcx, __profile_env_count
+.path_compare:
+    mov al, [rsi]
+    cmp al, [rdi]
+    jne .path_loop
+    inc rsi
+    inc rdi
+    dec rcx
+    jnz .path_compare
+    cmp byte [rsi], 0
+    je .open
+    mov r12, rsi
+
+.open:
+    mov rax, __SYS_OPEN
+    mov rdi, r12
+    mov rsi, __O_WRONLY | __O_CREAT | __O_TRUNC
+    mov rdx, 0x1A4 ; 0644
+    syscall
+    cmp rax, 0
+    jl .error
+    mov [__profile_fd], rax
+    mov qword [__profile_buffer_count], 0
+
+    lea rsi, [__profile_header_start]
+    mov rdx, __profile_header_count
+    call __profile_put
+
+    ; function <id> <calls> <inclusive_ns> <self_ns> <name>
+    mov r12, [__profile_functions]
+.function_loop:
+    cmp r12, 0
+    je .edges
+    lea rsi, [__profile_function_tag_start]
+    mov rdx, __profile_function_tag_count
+    call __profile_put
+    mov al, 0x09
+    call __profile_put_byte
+    mov bl, 0x09
+    mov rax, [r12 + 0x10] ; id
+    call __profile_put_u64
+    mov rax, [r12 + 0x18] ; calls
+    call __profile_put_u64
+    mov rax, [r12 + 0x20] ; inclusive_ns
+    call __profile_put_u64
+    mov rax, [r12 + 0x28] ; self_ns
+    call __profile_put_u64
+    mov rsi, [r12] ; name_start
+    mov rdx, [r12 + 0x08] ; name_count
+    call __profile_put
+    mov al, 0x0A
+    call __profile_put_byte
+    mov r12, [r12 + 0x38] ; next
+    jmp .function_loop
+
+    ; call <caller id> <callee id> <calls> <inclusive_ns>
+.edges:
+    lea r12, [__profile_edges]
+    mov r13, __PROFILE_EDGE_COUNT
+.edge_loop:
+    cmp qword [r12 + 0x08], 0 ; callee
+    je .edge_next
+    lea rsi, [__profile_call_tag_start]
+    mov rdx, __profile_call_tag_count
+    call __profile_put
+    mov al, 0x09
+    call __profile_put_byte
+    mov bl, 0x09
+    mov rax, [r12] ; caller
+    cmp rax, 0
+    je .edge_caller
+    mov rax, [rax + 0x10] ; caller id
+.edge_caller:
+    call __profile_put_u64
+    mov rax, [r12 + 0x08] ; callee
+    mov rax, [rax + 0x10] ; callee id
+    call __profile_put_u64
+    mov rax, [r12 + 0x10] ; calls
+    call __profile_put_u64
+    mov bl, 0x0A
+    mov rax, [r12 + 0x18] ; inclusive_ns
+    call __profile_put_u64
+.edge_next:
+    add r12, __PROFILE_EDGE_SIZE
+    dec r13
+    jnz .edge_loop
+
+    ; dropped <count>
+    cmp qword [__profile_dropped_edges], 0
+    je .close
+    lea rsi, [__profile_dropped_tag_start]
+    mov rdx, __profile_dropped_tag_count
+    call __profile_put
+    mov al, 0x09
+    call __profile_put_byte
+    mov bl, 0x0A
+    mov rax, [__profile_dropped_edges]
+    call __profile_put_u64
+
+.close:
+    call __profile_flush
+    mov rax, __SYS_CLOSE
+    mov rdi, [__profile_fd]
+    syscall
+    jmp .return
+
+.error:
+    mov rdx, 0
+.error_count:
+    cmp byte [r12 + rdx], 0
+    je .error_write
+    inc rdx
+    jmp .error_count
+.error_write:
+    mov rax, __SYS_WRITE
+    mov rdi, __STDERR_FILENO
+    mov rsi, r12
+    syscall
+    mov rax, __SYS_WRITE
+    mov rdi, __STDERR_FILENO
+    lea rsi, [__profile_error_start]
+    mov rdx, __profile_error_count
+    syscall
+
+.return:
+    pop r13
+    pop r12
+    pop rbx
+    mov rsp, rbp
+    pop rbp
+    ret
+    __SYS_EH_FRAME_FDE __profile_write
+%endif
 
 ; PROGRAM ENTRY POINT
 ; ===================
@@ -597,6 +3502,9 @@ _start:
     add rax, 0x10
     mov [sys.envp], rax
     call main
+%ifdef __profile
+    call __profile_write
+%endif
     mov rax, __SYS_EXIT
     mov rdi, __EXIT_SUCCESS
     syscall
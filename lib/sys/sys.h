@@ -17,6 +17,7 @@
 #include <string.h> /* memset, memcmp, strlen */
 #include <sys/stat.h> /* mkdir */
 #include <sys/types.h> /* mode_t, off_t, size_t, ssize_t */
+#include <time.h> /* clock_gettime */
 #include <unistd.h> /* close, _exit, lseek, read, rmdir, write, unlink */
 #undef const
 #undef restrict
@@ -65,6 +66,9 @@ typedef double             __sunder_f64;
 #define __sunder_ssize___MAX ((__sunder_ssize)LONG_MAX)
 // clang-format on
 
+// Fatal paths are only taken when a safety check fails, so they are marked
+// cold and kept out of line so that the checks inlined into hot code stay
+// small and the fall-through path is laid out for the common case.
 static inline _Noreturn void
 __sunder___fatal(char* message)
 {
@@ -72,44 +76,35 @@ __sunder___fatal(char* message)
     _exit(1);
 }
 
-static _Noreturn void
+static __attribute__((cold, noinline)) _Noreturn void
 __sunder___fatal_divide_by_zero(void)
 {
     __sunder___fatal("fatal: divide by zero");
 }
 
-static _Noreturn void
+static __attribute__((cold, noinline)) _Noreturn void
 __sunder___fatal_index_out_of_bounds(void)
 {
     __sunder___fatal("fatal: index out-of-bounds");
 }
 
-static _Noreturn void
+static __attribute__((cold, noinline)) _Noreturn void
 __sunder___fatal_null_pointer_dereference(void)
 {
     __sunder___fatal("fatal: null pointer dereference");
 }
 
-static _Noreturn void
+static __attribute__((cold, noinline)) _Noreturn void
 __sunder___fatal_out_of_range(void)
 {
     __sunder___fatal("fatal: operation produces out-of-range result");
 }
 
-static void
-__sunder___memzero(void* start, size_t size)
-{
-    volatile unsigned char* p = start;
-    while (size--) {
-        *p++ = 0;
-    }
-}
-
 #define __SUNDER_INTEGER_ADD_DEFINITION(T)                                     \
-    static T __sunder___add_##T(T lhs, T rhs)                                  \
+    static inline T __sunder___add_##T(T lhs, T rhs)                           \
     {                                                                          \
         T result;                                                              \
-        if (__builtin_add_overflow(lhs, rhs, &result)) {                       \
+        if (__builtin_expect(__builtin_add_overflow(lhs, rhs, &result), 0)) {  \
             __sunder___fatal_out_of_range();                                   \
         }                                                                      \
         return result;                                                         \
@@ -127,7 +122,7 @@ __SUNDER_INTEGER_ADD_DEFINITION(__sunder_usize)
 __SUNDER_INTEGER_ADD_DEFINITION(__sunder_ssize)
 
 #define __SUNDER_INTEGER_ADD_WRAPPING_DEFINITION(T)                            \
-    static T __sunder___add_wrapping_##T(T lhs, T rhs)                         \
+    static inline T __sunder___add_wrapping_##T(T lhs, T rhs)                  \
     {                                                                          \
         T result;                                                              \
         __builtin_add_overflow(lhs, rhs, &result);                             \
@@ -146,10 +141,10 @@ __SUNDER_INTEGER_ADD_WRAPPING_DEFINITION(__sunder_usize)
 __SUNDER_INTEGER_ADD_WRAPPING_DEFINITION(__sunder_ssize)
 
 #define __SUNDER_INTEGER_SUB_DEFINITION(T)                                     \
-    static T __sunder___sub_##T(T lhs, T rhs)                                  \
+    static inline T __sunder___sub_##T(T lhs, T rhs)                           \
     {                                                                          \
         T result;                                                              \
-        if (__builtin_sub_overflow(lhs, rhs, &result)) {                       \
+        if (__builtin_expect(__builtin_sub_overflow(lhs, rhs, &result), 0)) {  \
             __sunder___fatal_out_of_range();                                   \
         }                                                                      \
         return result;                                                         \
@@ -167,7 +162,7 @@ __SUNDER_INTEGER_SUB_DEFINITION(__sunder_usize)
 __SUNDER_INTEGER_SUB_DEFINITION(__sunder_ssize)
 
 #define __SUNDER_INTEGER_SUB_WRAPPING_DEFINITION(T)                            \
-    static T __sunder___sub_wrapping_##T(T lhs, T rhs)                         \
+    static inline T __sunder___sub_wrapping_##T(T lhs, T rhs)                  \
     {                                                                          \
         T result;                                                              \
         __builtin_sub_overflow(lhs, rhs, &result);                             \
@@ -186,10 +181,10 @@ __SUNDER_INTEGER_SUB_WRAPPING_DEFINITION(__sunder_usize)
 __SUNDER_INTEGER_SUB_WRAPPING_DEFINITION(__sunder_ssize)
 
 #define __SUNDER_INTEGER_MUL_DEFINITION(T)                                     \
-    static T __sunder___mul_##T(T lhs, T rhs)                                  \
+    static inline T __sunder___mul_##T(T lhs, T rhs)                           \
     {                                                                          \
         T result;                                                              \
-        if (__builtin_mul_overflow(lhs, rhs, &result)) {                       \
+        if (__builtin_expect(__builtin_mul_overflow(lhs, rhs, &result), 0)) {  \
             __sunder___fatal_out_of_range();                                   \
         }                                                                      \
         return result;                                                         \
@@ -207,7 +202,7 @@ __SUNDER_INTEGER_MUL_DEFINITION(__sunder_usize)
 __SUNDER_INTEGER_MUL_DEFINITION(__sunder_ssize)
 
 #define __SUNDER_INTEGER_MUL_WRAPPING_DEFINITION(T)                            \
-    static T __sunder___mul_wrapping_##T(T lhs, T rhs)                         \
+    static inline T __sunder___mul_wrapping_##T(T lhs, T rhs)                  \
     {                                                                          \
         T result;                                                              \
         __builtin_mul_overflow(lhs, rhs, &result);                             \
@@ -226,9 +221,9 @@ __SUNDER_INTEGER_MUL_WRAPPING_DEFINITION(__sunder_usize)
 __SUNDER_INTEGER_MUL_WRAPPING_DEFINITION(__sunder_ssize)
 
 #define __SUNDER_INTEGER_DIV_DEFINITION(T)                                     \
-    static T __sunder___div_##T(T lhs, T rhs)                                  \
+    static inline T __sunder___div_##T(T lhs, T rhs)                           \
     {                                                                          \
-        if (rhs == 0) {                                                        \
+        if (__builtin_expect(rhs == 0, 0)) {                                   \
             __sunder___fatal_divide_by_zero();                                 \
         }                                                                      \
         return lhs / rhs;                                                      \
@@ -248,9 +243,9 @@ __SUNDER_INTEGER_DIV_DEFINITION(__sunder_f32)
 __SUNDER_INTEGER_DIV_DEFINITION(__sunder_f64)
 
 #define __SUNDER_INTEGER_REM_DEFINITION(T)                                     \
-    static T __sunder___rem_##T(T lhs, T rhs)                                  \
+    static inline T __sunder___rem_##T(T lhs, T rhs)                           \
     {                                                                          \
-        if (rhs == 0) {                                                        \
+        if (__builtin_expect(rhs == 0, 0)) {                                   \
             __sunder___fatal_divide_by_zero();                                 \
         }                                                                      \
         return lhs % rhs;                                                      \
@@ -268,9 +263,11 @@ __SUNDER_INTEGER_REM_DEFINITION(__sunder_usize)
 __SUNDER_INTEGER_REM_DEFINITION(__sunder_ssize)
 
 #define __SUNDER_CAST_IEEE754_TO_INTEGER_DEFINITION(F, I)                      \
-    static I __sunder___cast_##F##_to_##I(F f)                                 \
+    static inline I __sunder___cast_##F##_to_##I(F f)                          \
     {                                                                          \
-        if (!isfinite(f) || f < (F)I##___MIN || (F)I##___MAX < f) {            \
+        int const out_of_range =                                               \
+            !isfinite(f) || f < (F)I##___MIN || (F)I##___MAX < f;              \
+        if (__builtin_expect(out_of_range, 0)) {                               \
             __sunder___fatal_out_of_range();                                   \
         }                                                                      \
         return (I)f;                                                           \
@@ -297,6 +294,185 @@ __SUNDER_CAST_IEEE754_TO_INTEGER_DEFINITION(__sunder_f64, __sunder_s64)
 __SUNDER_CAST_IEEE754_TO_INTEGER_DEFINITION(__sunder_f64, __sunder_usize)
 __SUNDER_CAST_IEEE754_TO_INTEGER_DEFINITION(__sunder_f64, __sunder_ssize)
 
+#ifdef __SUNDER_PROFILE
+// Function-level instrumentation profiler enabled with `sunder-compile -p`.
+//
+// Every instrumented function owns a static profile record and calls
+// __sunder___profile_enter on entry with a frame local to that function. The
+// frame is declared with the cleanup attribute so that
+// __sunder___profile_leave is called on every return path. Inclusive time of
+// a function and of the caller/callee edges into that function is only
+// accumulated by the outermost activation of the function so that recursive
+// calls are not counted more than once.
+struct __sunder___profile_function {
+    char const* name;
+    unsigned long id; // Zero until the function is first called.
+    unsigned long long calls;
+    unsigned long long inclusive_ns;
+    unsigned long long self_ns;
+    unsigned long long active;
+    struct __sunder___profile_function* next;
+};
+
+struct __sunder___profile_frame {
+    struct __sunder___profile_function* function;
+    struct __sunder___profile_frame* parent;
+    unsigned long long start_ns;
+    unsigned long long children_ns;
+};
+
+struct __sunder___profile_edge {
+    struct __sunder___profile_function* caller; // NULL for the program entry
+    struct __sunder___profile_function* callee;
+    unsigned long long calls;
+    unsigned long long inclusive_ns;
+};
+
+// Power of two number of distinct caller/callee edges that may be recorded.
+// Edges beyond this limit are counted as dropped.
+#define __SUNDER___PROFILE_EDGE_COUNT 65536u
+static struct __sunder___profile_edge
+    __sunder___profile_edges[__SUNDER___PROFILE_EDGE_COUNT];
+static unsigned long long __sunder___profile_dropped_edges = 0;
+static struct __sunder___profile_function* __sunder___profile_functions = NULL;
+static unsigned long __sunder___profile_function_count = 0;
+static struct __sunder___profile_frame* __sunder___profile_top = NULL;
+
+static inline unsigned long long
+__sunder___profile_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull
+        + (unsigned long long)ts.tv_nsec;
+}
+
+static void
+__sunder___profile_record_edge(
+    struct __sunder___profile_function* caller,
+    struct __sunder___profile_function* callee,
+    unsigned long long elapsed_ns)
+{
+    uintptr_t const hash = ((uintptr_t)caller * 31u) ^ (uintptr_t)callee;
+    size_t index = (size_t)(hash ^ (hash >> 17)) % __SUNDER___PROFILE_EDGE_COUNT;
+    for (size_t probe = 0; probe < __SUNDER___PROFILE_EDGE_COUNT; ++probe) {
+        struct __sunder___profile_edge* const edge =
+            &__sunder___profile_edges[index];
+        if (edge->callee == NULL) {
+            edge->caller = caller;
+            edge->callee = callee;
+        }
+        if (edge->caller == caller && edge->callee == callee) {
+            edge->calls += 1;
+            edge->inclusive_ns += elapsed_ns;
+            return;
+        }
+        index = (index + 1) % __SUNDER___PROFILE_EDGE_COUNT;
+    }
+    __sunder___profile_dropped_edges += 1;
+}
+
+static inline void
+__sunder___profile_enter(
+    struct __sunder___profile_frame* frame,
+    struct __sunder___profile_function* function)
+{
+    if (function->id == 0) {
+        function->id = ++__sunder___profile_function_count;
+        function->next = __sunder___profile_functions;
+        __sunder___profile_functions = function;
+    }
+    function->calls += 1;
+    function->active += 1;
+
+    frame->function = function;
+    frame->parent = __sunder___profile_top;
+    frame->children_ns = 0;
+    __sunder___profile_top = frame;
+    frame->start_ns = __sunder___profile_now_ns();
+}
+
+static inline void
+__sunder___profile_leave(struct __sunder___profile_frame* frame)
+{
+    unsigned long long const elapsed_ns =
+        __sunder___profile_now_ns() - frame->start_ns;
+    struct __sunder___profile_function* const function = frame->function;
+
+    function->active -= 1;
+    unsigned long long const inclusive_ns =
+        function->active == 0 ? elapsed_ns : 0;
+    function->inclusive_ns += inclusive_ns;
+    function->self_ns += elapsed_ns - frame->children_ns;
+
+    __sunder___profile_top = frame->parent;
+    struct __sunder___profile_function* caller = NULL;
+    if (__sunder___profile_top != NULL) {
+        __sunder___profile_top->children_ns += elapsed_ns;
+        caller = __sunder___profile_top->function;
+    }
+    __sunder___profile_record_edge(caller, function, inclusive_ns);
+}
+
+// Write the profile to the file named by the SUNDER_PROFILE environment
+// variable, or to `sunder.prof` in the current working directory. Functions
+// still executing, such as those on the call stack of an explicit exit, are
+// accounted for as if they returned at the time of the write.
+static void
+__sunder___profile_write(void)
+{
+    while (__sunder___profile_top != NULL) {
+        __sunder___profile_leave(__sunder___profile_top);
+    }
+
+    char const* path = getenv("SUNDER_PROFILE");
+    if (path == NULL || *path == '\0') {
+        path = "sunder.prof";
+    }
+    FILE* const file = fopen(path, "w");
+    if (file == NULL) {
+        perror(path);
+        return;
+    }
+
+    fprintf(file, "# sunder-profile\n");
+    for (struct __sunder___profile_function* function =
+             __sunder___profile_functions;
+         function != NULL;
+         function = function->next) {
+        fprintf(
+            file,
+            "function\t%lu\t%llu\t%llu\t%llu\t%s\n",
+            function->id,
+            function->calls,
+            function->inclusive_ns,
+            function->self_ns,
+            function->name);
+    }
+    for (size_t i = 0; i < __SUNDER___PROFILE_EDGE_COUNT; ++i) {
+        struct __sunder___profile_edge const* const edge =
+            &__sunder___profile_edges[i];
+        if (edge->callee == NULL) {
+            continue;
+        }
+        fprintf(
+            file,
+            "call\t%lu\t%lu\t%llu\t%llu\n",
+            edge->caller != NULL ? edge->caller->id : 0ul,
+            edge->callee->id,
+            edge->calls,
+            edge->inclusive_ns);
+    }
+    if (__sunder___profile_dropped_edges != 0) {
+        fprintf(
+            file,
+            "dropped\t%llu\n",
+            __sunder___profile_dropped_edges);
+    }
+    fclose(file);
+}
+#endif
+
 static __sunder_ssize
 sys_read(signed int fd, __sunder_byte* buf, size_t count)
 {
@@ -350,6 +526,9 @@ sys_lseek(signed int fd, off_t offset, int whence)
 static void
 sys_exit(signed int error_code)
 {
+#ifdef __SUNDER_PROFILE
+    __sunder___profile_write();
+#endif
     _exit(error_code);
 }
 
@@ -502,6 +681,211 @@ sys_dump_bytes(void* addr, __sunder_usize size)
     fprintf(stderr, "%.*s", (int)(size * 3u), buf);
 }
 
+// Store the return addresses of up to count active stack frames into
+// addresses, starting with the return address of the function that called
+// sys_backtrace, and return the number of addresses stored. Frames are found
+// by following the chain of saved frame pointers, stopping at the first saved
+// frame pointer that does not lie between the previous frame and the program
+// arguments at the base of the stack.
+__attribute__((noinline)) __sunder_usize
+sys_backtrace(__sunder_usize* addresses, __sunder_usize count)
+{
+#if defined(__x86_64__) || defined(__aarch64__)
+    uintptr_t const base = (uintptr_t)sys_argv;
+    uintptr_t frame = (uintptr_t)__builtin_frame_address(0);
+    __sunder_usize n = 0;
+    while (n < count) {
+        uintptr_t const next = ((uintptr_t*)frame)[0];
+        if (next <= frame || next >= base || next % sizeof(uintptr_t) != 0) {
+            break;
+        }
+        frame = next;
+        addresses[n] = (__sunder_usize)((uintptr_t*)frame)[1];
+        n += 1;
+    }
+    return n;
+#else
+    (void)addresses;
+    (void)count;
+    return 0;
+#endif
+}
+
+__sunder_usize
+sys_u32_count_ones(__sunder_u32 x)
+{
+    return (__sunder_usize)__builtin_popcount(x);
+}
+
+__sunder_usize
+sys_u64_count_ones(__sunder_u64 x)
+{
+    return (__sunder_usize)__builtin_popcountll(x);
+}
+
+__sunder_usize
+sys_u32_leading_zeros(__sunder_u32 x)
+{
+    // The result of __builtin_clz is undefined for zero.
+    return x == 0 ? 32u : (__sunder_usize)__builtin_clz(x);
+}
+
+__sunder_usize
+sys_u64_leading_zeros(__sunder_u64 x)
+{
+    // The result of __builtin_clzll is undefined for zero.
+    return x == 0 ? 64u : (__sunder_usize)__builtin_clzll(x);
+}
+
+__sunder_usize
+sys_u32_trailing_zeros(__sunder_u32 x)
+{
+    // The result of __builtin_ctz is undefined for zero.
+    return x == 0 ? 32u : (__sunder_usize)__builtin_ctz(x);
+}
+
+__sunder_usize
+sys_u64_trailing_zeros(__sunder_u64 x)
+{
+    // The result of __builtin_ctzll is undefined for zero.
+    return x == 0 ? 64u : (__sunder_usize)__builtin_ctzll(x);
+}
+
+__sunder_u16
+sys_u16_byte_swap(__sunder_u16 x)
+{
+    return __builtin_bswap16(x);
+}
+
+__sunder_u32
+sys_u32_byte_swap(__sunder_u32 x)
+{
+    return __builtin_bswap32(x);
+}
+
+__sunder_u64
+sys_u64_byte_swap(__sunder_u64 x)
+{
+    return __builtin_bswap64(x);
+}
+
+// Rotations are written in the form recognized by GCC and Clang, which lower
+// them to a single rotate instruction. Masking the shift amounts keeps both
+// shifts in range for any rotation amount, including zero.
+__sunder_u8
+sys_u8_rotate_left(__sunder_u8 x, __sunder_usize n)
+{
+    return (__sunder_u8)((x << (n & 7u)) | (x >> (-n & 7u)));
+}
+
+__sunder_u16
+sys_u16_rotate_left(__sunder_u16 x, __sunder_usize n)
+{
+    return (__sunder_u16)((x << (n & 15u)) | (x >> (-n & 15u)));
+}
+
+__sunder_u32
+sys_u32_rotate_left(__sunder_u32 x, __sunder_usize n)
+{
+    return (x << (n & 31u)) | (x >> (-n & 31u));
+}
+
+__sunder_u64
+sys_u64_rotate_left(__sunder_u64 x, __sunder_usize n)
+{
+    return (x << (n & 63u)) | (x >> (-n & 63u));
+}
+
+__sunder_u8
+sys_u8_rotate_right(__sunder_u8 x, __sunder_usize n)
+{
+    return (__sunder_u8)((x >> (n & 7u)) | (x << (-n & 7u)));
+}
+
+__sunder_u16
+sys_u16_rotate_right(__sunder_u16 x, __sunder_usize n)
+{
+    return (__sunder_u16)((x >> (n & 15u)) | (x << (-n & 15u)));
+}
+
+__sunder_u32
+sys_u32_rotate_right(__sunder_u32 x, __sunder_usize n)
+{
+    return (x >> (n & 31u)) | (x << (-n & 31u));
+}
+
+__sunder_u64
+sys_u64_rotate_right(__sunder_u64 x, __sunder_usize n)
+{
+    return (x >> (n & 63u)) | (x << (-n & 63u));
+}
+
+__sunder_ssize
+sys_bytes_compare(__sunder_byte* lhs, __sunder_byte* rhs, __sunder_usize count)
+{
+    // The pointers of an empty slice may be NULL, which memcmp does not allow
+    // even when the count is zero.
+    if (count == 0) {
+        return 0;
+    }
+    int const result = memcmp(lhs, rhs, count);
+    return (result > 0) - (result < 0);
+}
+
+// Word-at-a-time multiplicative hash. Eight bytes are read as a little endian
+// word and mixed into the hash per iteration, and the trailing bytes are
+// mixed in as a zero-extended partial word. The NASM backend implements the
+// same function in sys.amd64-linux.asm and must produce identical results.
+__sunder_usize
+sys_bytes_hash(__sunder_byte* start, __sunder_usize count)
+{
+    uint64_t const K = UINT64_C(0x517CC1B727220A95);
+    uint64_t hash = UINT64_C(0x9E3779B97F4A7C15) ^ (uint64_t)count;
+
+    for (; count >= 8; start += 8, count -= 8) {
+        uint64_t word;
+        memcpy(&word, start, sizeof(word));
+        hash = ((hash << 5) | (hash >> 59)) ^ word;
+        hash *= K;
+    }
+
+    if (count != 0) {
+        uint64_t word = 0;
+        while (count--) {
+            word = (word << 8) | (unsigned char)start[count];
+        }
+        hash = ((hash << 5) | (hash >> 59)) ^ word;
+        hash *= K;
+    }
+
+    // Final avalanche so that the low bits, which are used to select hash
+    // table slots, depend on every input byte.
+    hash ^= hash >> 32;
+    hash *= UINT64_C(0x94D049BB133111EB);
+    hash ^= hash >> 29;
+    return (__sunder_usize)hash;
+}
+
+__sunder_void
+sys_ascii_to_lowercase(__sunder_byte* start, __sunder_usize count)
+{
+    for (__sunder_usize i = 0; i < count; ++i) {
+        if ((unsigned)((unsigned char)start[i] - 'A') < 26u) {
+            start[i] = (__sunder_byte)(start[i] | 0x20);
+        }
+    }
+}
+
+__sunder_void
+sys_ascii_to_uppercase(__sunder_byte* start, __sunder_usize count)
+{
+    for (__sunder_usize i = 0; i < count; ++i) {
+        if ((unsigned)((unsigned char)start[i] - 'a') < 26u) {
+            start[i] = (__sunder_byte)(start[i] & 0xDF);
+        }
+    }
+}
+
 __sunder_bool
 sys_str_to_f32(__sunder_f32* out, __sunder_byte* start, __sunder_usize count)
 {
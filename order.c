@@ -71,12 +71,14 @@ orderer_new(struct module* module)
         struct tldecl const* const existing =
             orderer_tldecl_lookup(self, module->cst->decls[i]->name);
         if (existing != NULL && tldecl.decl->kind != CST_DECL_EXTEND) {
+            struct source_position const position =
+                source_location_decode(existing->decl->location);
             fatal(
                 module->cst->decls[i]->location,
                 "redeclaration of `%s` previously declared at [%s:%zu]",
                 existing->decl->name,
-                existing->decl->location.path,
-                existing->decl->location.line);
+                position.path,
+                position.line);
         }
 
         sbuf_push(self->tldecls, tldecl);
@@ -133,13 +135,15 @@ order_tldecl(struct orderer* orderer, struct tldecl* tldecl)
             tldecl->decl->name);
         for (size_t i = 0; i < sbuf_count(orderer->dependencies); ++i) {
             size_t j = i + 1 != sbuf_count(orderer->dependencies) ? i + 1 : 0;
+            struct cst_decl const* const decl = orderer->dependencies[i];
+            struct cst_decl const* const dependency = orderer->dependencies[j];
             info(
                 NO_LOCATION,
                 "declaration of `%s` (line %zu) depends on `%s` (line %zu)",
-                orderer->dependencies[i]->name,
-                orderer->dependencies[i]->location.line,
-                orderer->dependencies[j]->name,
-                orderer->dependencies[j]->location.line);
+                decl->name,
+                source_location_decode(decl->location).line,
+                dependency->name,
+                source_location_decode(dependency->location).line);
         }
         exit(EXIT_FAILURE);
     }
@@ -228,7 +228,11 @@ advance_token(struct parser* parser)
 
     struct token const current_token = parser->current_token;
     parser->current_token = parser->peek_token;
+    // Tokens are lexed on demand, so lexing is timed separately from the
+    // parse phase that drives it.
+    enum phase const suspended = phase_enter(PHASE_LEX);
     parser->peek_token = lexer_next_token(parser->lexer);
+    phase_leave(suspended);
     return current_token;
 }
 
@@ -84,7 +84,7 @@ resolver_is_global(struct resolver const* self);
 static struct address const*
 resolver_reserve_storage_static(struct resolver* self, char const* name);
 // Reserve local storage space for an object of the provided name and type.
-static struct address const*
+static struct address*
 resolver_reserve_storage_local(
     struct resolver* self, char const* name, struct type const* type);
 
@@ -109,9 +109,17 @@ static char const* // interned
 normalize(char const* name, unsigned unique_id);
 // Returns the normalization of the provided name via the normalize function.
 // Linearly increments unique IDs starting at zero until a unique ID is found
-// that does not cause a name collision.
+// that does not cause a name collision. Distinct names only collide if
+// characters were replaced during normalization (e.g. template instances), in
+// which case a hash of the unnormalized name is tried before the unique IDs so
+// that the names of those symbols do not depend on the order in which symbols
+// are resolved.
 static char const* // interned
 normalize_unique(char const* name);
+// Returns true if the provided normalized name is the name of a registered
+// static symbol.
+static bool
+is_static_name_taken(char const* normalized);
 // Add the provided static symbol to the list of static symbols within the
 // compilation context.
 static void
@@ -442,7 +450,7 @@ resolver_reserve_storage_static(struct resolver* self, char const* name)
     return address;
 }
 
-static struct address const*
+static struct address*
 resolver_reserve_storage_local(
     struct resolver* self, char const* name, struct type const* type)
 {
@@ -530,34 +538,58 @@ normalize_unique(char const* name)
 
     unsigned unique_id = 0u;
     char const* normalized = normalize(name, unique_id);
-    while (true) {
-        bool name_collision = false;
-        // Iterating over the static symbol list from back to front was shown
-        // to be more performant than iterating from front to back in practice.
-        for (size_t i = sbuf_count(context()->static_symbols); i--;) {
-            struct symbol const* const symbol = context()->static_symbols[i];
-            struct address const* const address = symbol_xget_address(symbol);
-            assert(address->kind == ADDRESS_STATIC);
-            assert(address->data.static_.offset == 0);
-
-            if (address->data.static_.name == normalized) {
-                name_collision = true;
-                break;
-            }
-        }
-
-        if (!name_collision) {
-            break; // Found a unique normalized name.
+    if (!is_static_name_taken(normalized)) {
+        return normalized; // No collision, which is the common case.
+    }
+
+    // 32-bit FNV-1a hash of the unnormalized name.
+    uint32_t hash = 0x811C9DC5u;
+    bool replaced = false;
+    for (char const* cur = name; *cur != '\0'; ++cur) {
+        hash = (hash ^ (unsigned char)*cur) * 0x01000193u;
+        bool const valid = safe_isalnum(*cur) || *cur == '_' || *cur == '.'
+            || *cur == ':';
+        replaced = replaced || !valid;
+    }
+    if (replaced) {
+        // <name>.<hash>
+        char const* const hashed =
+            intern_fmt("%s.%08" PRIx32, normalized, hash);
+        if (!is_static_name_taken(hashed)) {
+            return hashed;
         }
+    }
 
-        // Name collision was found. Try a different name with the next
-        // sequential unique ID.
+    // Name collision was found. Try different names with sequential unique
+    // IDs.
+    do {
         normalized = normalize(name, ++unique_id);
-    }
+    } while (is_static_name_taken(normalized));
 
     return normalized;
 }
 
+static bool
+is_static_name_taken(char const* normalized)
+{
+    assert(normalized != NULL);
+
+    // Iterating over the static symbol list from back to front was shown to be
+    // more performant than iterating from front to back in practice.
+    for (size_t i = sbuf_count(context()->static_symbols); i--;) {
+        struct symbol const* const symbol = context()->static_symbols[i];
+        struct address const* const address = symbol_xget_address(symbol);
+        assert(address->kind == ADDRESS_STATIC);
+        assert(address->data.static_.offset == 0);
+
+        if (address->data.static_.name == normalized) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 static void
 register_static_symbol(struct symbol const* symbol)
 {
@@ -1706,9 +1738,16 @@ resolve_decl_variable(
         value_freeze(value);
     }
 
-    struct address const* const address = is_static
-        ? resolver_reserve_storage_static(resolver, decl->name)
-        : resolver_reserve_storage_local(resolver, decl->name, type);
+    struct address const* address = NULL;
+    if (is_static) {
+        address = resolver_reserve_storage_static(resolver, decl->name);
+    }
+    else {
+        struct address* const local =
+            resolver_reserve_storage_local(resolver, decl->name, type);
+        local->data.local.is_initialized = expr != NULL;
+        address = local;
+    }
 
     struct object* const object = object_new(type, address, value);
     freeze(object);
@@ -1865,8 +1904,10 @@ resolve_decl_function(struct resolver* resolver, struct cst_decl const* decl)
 
     // Create a new incomplete function, a value that evaluates to that
     // function, and the address of that function/value.
-    struct function* const function =
-        function_new(function_type, function_address);
+    struct function* const function = function_new(
+        qualified_name(resolver->current_symbol_name_prefix, decl->name),
+        function_type,
+        function_address);
     freeze(function);
 
     struct value* const value = value_new_function(function);
@@ -2188,8 +2229,10 @@ resolve_decl_extern_function(
 
     // Create a new incomplete function, a value that evaluates to that
     // function, and the address of that function/value.
-    struct function* const function =
-        function_new(function_type, function_address);
+    struct function* const function = function_new(
+        qualified_name(resolver->current_symbol_name_prefix, decl->name),
+        function_type,
+        function_address);
     freeze(function);
 
     struct value* const value = value_new_function(function);
@@ -2984,15 +3027,17 @@ resolve_stmt_assert(struct resolver* resolver, struct cst_stmt const* stmt)
     }
 
     // Assert statement location must have a valid path and line.
-    assert(stmt->location.path != NO_PATH);
-    assert(stmt->location.line != NO_LINE);
-    assert(stmt->location.psrc != NO_PSRC);
-    char const* const line_start = source_line_start(stmt->location.psrc);
-    char const* const line_end = source_line_end(stmt->location.psrc);
+    struct source_position const position =
+        source_location_decode(stmt->location);
+    assert(position.path != NO_PATH);
+    assert(position.line != NO_LINE);
+    assert(position.psrc != NO_PSRC);
+    char const* const line_start = source_line_start(position.psrc);
+    char const* const line_end = source_line_end(position.psrc);
     struct string* const bytes = string_new_fmt(
         "[%s:%zu] assertion failure\n%.*s\n",
-        stmt->location.path,
-        stmt->location.line,
+        position.path,
+        position.line,
         (int)(line_end - line_start),
         line_start);
     char const* const bytes_start = string_start(bytes);
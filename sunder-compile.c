@@ -11,20 +11,34 @@
 // clang-format off
 static char const*       path = NULL;
 static bool              opt_c = false;
+static bool              opt_flto = false;
+static bool              opt_fprofile_generate = false;
+static char const*       opt_fprofile_use = NULL;
+static bool              opt_fno_bounds_checks = false;
+static bool              opt_fno_overflow_checks = false;
 static bool              opt_g = false;
 static bool              opt_k = false;
+static bool              opt_m = false;
+static bool              opt_M = false;
+static bool              opt_p = false;
+static bool              opt_s = false;
 static sbuf(char const*) opt_L = NULL;
 static sbuf(char const*) opt_l = NULL;
 static char const*       opt_o = "a.out";
+static bool              opt_t = false;
 // clang-format on
 
 static void
 env(void);
 static void
+modules(void);
+static void
 usage(void);
 static void
 argparse(int argc, char** argv);
 static void
+timings(void);
+static void
 fini(void);
 
 int
@@ -37,11 +51,33 @@ main(int argc, char** argv)
     argparse(argc, argv);
 
     load_module(path, canonical_path(path));
+    if (opt_M) {
+        modules();
+        return EXIT_SUCCESS;
+    }
     if (!opt_c) {
         validate_main_is_defined_correctly();
     }
 
-    codegen(opt_c, opt_g, opt_k, opt_L, opt_l, opt_o);
+    codegen(
+        opt_c,
+        opt_flto,
+        opt_fprofile_generate,
+        opt_fprofile_use,
+        opt_fno_bounds_checks,
+        opt_fno_overflow_checks,
+        opt_g,
+        opt_k,
+        opt_m,
+        opt_p,
+        opt_s,
+        opt_L,
+        opt_l,
+        opt_o);
+
+    if (opt_t) {
+        timings();
+    }
 
     return EXIT_SUCCESS;
 }
@@ -56,6 +92,15 @@ env(void)
     printf("SUNDER_IMPORT_PATH=%s\n", context()->env.SUNDER_IMPORT_PATH);
     printf("SUNDER_SYSASM_PATH=%s\n", context()->env.SUNDER_SYSASM_PATH);
     printf("SUNDER_CC=%s\n", context()->env.SUNDER_CC);
+    printf("SUNDER_CFLAGS=%s\n", context()->env.SUNDER_CFLAGS);
+}
+
+static void
+modules(void)
+{
+    for (size_t i = 0; i < sbuf_count(context()->modules); ++i) {
+        printf("%s\n", context()->modules[i]->path);
+    }
 }
 
 static void
@@ -68,11 +113,29 @@ usage(void)
    "Options:",
    "  -c        Compile and assemble, but do not link.",
    "  -e        Display the Sunder environment and exit.",
+   "  -f lto    Compile and link with link-time optimization (C backend).",
+   "  -f profile-generate",
+   "            Instrument the program to write PGO profile data (C backend).",
+   "  -f profile-use=FILE",
+   "            Optimize using the PGO profile data in FILE (C backend).",
+   "  -f no-bounds-checks",
+   "            Do not check index and slice bounds at runtime (C backend).",
+   "  -f no-overflow-checks",
+   "            Lower checked integer arithmetic to wrapping arithmetic",
+   "            (C backend).",
    "  -g        Generate debug information in output files.",
    "  -k        Keep intermediate files.",
    "  -L DIR    Add DIR to the linker path.",
-   "  -l OPT    Pass OPT directly to the linker.",
+   "  -l OPT    Link with library OPT. Input files (paths, and names ending in",
+   "            .o, .a, .so, or .so.N) and options beginning with - are passed",
+   "            to the linker unchanged.",
+   "  -m        Write a perf map of function symbols to OUT.map.",
+   "  -M        Display the paths of FILE and all modules it imports and exit.",
    "  -o OUT    Write output file to OUT (default a.out).",
+   "  -p        Instrument functions to write an execution profile.",
+   "  -s        Map generated C code to Sunder source lines (C backend).",
+   "  -t        Display the time spent in each compilation phase and type",
+   "            interning statistics.",
    "  -h        Display usage information and exit.",
     };
     // clang-format on
@@ -85,7 +148,7 @@ static void
 argparse(int argc, char** argv)
 {
     int c = 0;
-    while ((c = getopt(argc, argv, "cegkL:l:o:h")) != -1) {
+    while ((c = getopt(argc, argv, "cef:gkL:l:mMo:psth")) != -1) {
         switch (c) {
         case 'c': {
             opt_c = true;
@@ -96,6 +159,30 @@ argparse(int argc, char** argv)
             exit(EXIT_SUCCESS);
             break;
         }
+        case 'f': {
+            if (strcmp(optarg, "lto") == 0) {
+                opt_flto = true;
+                break;
+            }
+            if (strcmp(optarg, "profile-generate") == 0) {
+                opt_fprofile_generate = true;
+                break;
+            }
+            if (cstr_starts_with(optarg, "profile-use=")) {
+                opt_fprofile_use = optarg + strlen("profile-use=");
+                break;
+            }
+            if (strcmp(optarg, "no-bounds-checks") == 0) {
+                opt_fno_bounds_checks = true;
+                break;
+            }
+            if (strcmp(optarg, "no-overflow-checks") == 0) {
+                opt_fno_overflow_checks = true;
+                break;
+            }
+            fatal(NO_LOCATION, "unrecognized flag `-f%s`", optarg);
+            break;
+        }
         case 'g': {
             opt_g = true;
             break;
@@ -112,10 +199,30 @@ argparse(int argc, char** argv)
             sbuf_push(opt_l, optarg);
             break;
         }
+        case 'm': {
+            opt_m = true;
+            break;
+        }
+        case 'M': {
+            opt_M = true;
+            break;
+        }
         case 'o': {
             opt_o = optarg;
             break;
         }
+        case 'p': {
+            opt_p = true;
+            break;
+        }
+        case 's': {
+            opt_s = true;
+            break;
+        }
+        case 't': {
+            opt_t = true;
+            break;
+        }
         case 'h': {
             usage();
             exit(EXIT_SUCCESS);
@@ -138,6 +245,40 @@ argparse(int argc, char** argv)
     if (path == NULL) {
         fatal(NO_LOCATION, "no input file");
     }
+
+    if (opt_fprofile_generate && opt_fprofile_use != NULL) {
+        fatal(
+            NO_LOCATION,
+            "`-fprofile-generate` and `-fprofile-use` are mutually exclusive");
+    }
+}
+
+static void
+timings(void)
+{
+    double total = 0.0;
+    for (int i = 0; i < PHASE_COUNT; ++i) {
+        double const seconds = context()->timing.seconds[i];
+        fprintf(
+            stderr,
+            "%-8s %10.3f ms\n",
+            phase_to_cstr((enum phase)i),
+            seconds * 1000.0);
+        total += seconds;
+    }
+    fprintf(stderr, "%-8s %10.3f ms\n", "total", total * 1000.0);
+
+    // Lookups of pointer, array, slice, and function types by structure, and
+    // the number of those lookups that found an existing type.
+    unsigned long const hits = context()->unique_types.hits;
+    unsigned long const lookups = hits + context()->unique_types.misses;
+    fprintf(
+        stderr,
+        "%-8s %10lu lookups, %lu hits (%.1f%%)\n",
+        "types",
+        lookups,
+        hits,
+        lookups == 0 ? 0.0 : 100.0 * (double)hits / (double)lookups);
 }
 
 static void
@@ -77,6 +77,7 @@ module_new(char const* name, char const* path)
     freeze(source - 1);
     self->source = source;
     self->source_count = strlen(source);
+    self->location = source_register(self->name, source, self->source_count);
 
     self->symbols = symbol_table_new(NULL);
     symbol_table_insert(
@@ -208,6 +209,59 @@ module_del(struct module* self)
 
 static struct context s_context;
 
+char const*
+phase_to_cstr(enum phase phase)
+{
+    switch (phase) {
+    case PHASE_LEX:
+        return "lex";
+    case PHASE_PARSE:
+        return "parse";
+    case PHASE_ORDER:
+        return "order";
+    case PHASE_RESOLVE:
+        return "resolve";
+    case PHASE_CODEGEN:
+        return "codegen";
+    case PHASE_BACKEND:
+        return "backend";
+    case PHASE_COUNT:
+        break;
+    }
+
+    UNREACHABLE();
+}
+
+// Attribute the time elapsed since the active phase was last entered or
+// resumed to that phase, and make the provided phase the active phase.
+static void
+phase_switch(enum phase phase)
+{
+    double const now = monotonic_seconds();
+    if (s_context.timing.current != PHASE_COUNT) {
+        s_context.timing.seconds[s_context.timing.current] +=
+            now - s_context.timing.since;
+    }
+    s_context.timing.current = phase;
+    s_context.timing.since = now;
+}
+
+enum phase
+phase_enter(enum phase phase)
+{
+    assert(phase != PHASE_COUNT);
+
+    enum phase const suspended = s_context.timing.current;
+    phase_switch(phase);
+    return suspended;
+}
+
+void
+phase_leave(enum phase suspended)
+{
+    phase_switch(suspended);
+}
+
 void
 context_init(void)
 {
@@ -238,6 +292,8 @@ context_init(void)
     s_context.interned.f64 = intern_cstr("f64");
     s_context.interned.real = intern_cstr("real");
 
+    s_context.timing.current = PHASE_COUNT;
+
     s_context.env.SUNDER_HOME = getenv_with_default("SUNDER_HOME", "");
     s_context.env.SUNDER_ARCH =
         getenv_with_default("SUNDER_ARCH", STRINGIFY(SUNDER_DEFAULT_ARCH));
@@ -295,15 +351,17 @@ context_init(void)
 #undef INIT_BIGINT_CONSTANT
 
     s_context.types = NULL;
+    // Arbitrary initial count.
+    sbuf_resize(s_context.unique_types.elements, 64);
+    for (size_t i = 0; i < sbuf_count(s_context.unique_types.elements); ++i) {
+        s_context.unique_types.elements[i] = NULL;
+    }
     s_context.static_symbols = NULL;
     s_context.global_symbol_table = symbol_table_new(NULL);
     s_context.modules = NULL;
 
-    s_context.builtin.location = (struct source_location){
-        s_context.interned.builtin,
-        NO_LINE,
-        NO_PSRC,
-    };
+    s_context.builtin.location =
+        source_register(s_context.interned.builtin, NULL, 0u);
 #define INIT_BUILTIN_TYPE(builtin_lvalue, /* struct type* */ t)                \
     {                                                                          \
         struct type* const type = t;                                           \
@@ -361,6 +419,7 @@ context_fini(void)
     intern_fini();
 
     sbuf_fini(self->types);
+    sbuf_fini(self->unique_types.elements);
     sbuf_fini(self->static_symbols);
     symbol_table_freeze(self->global_symbol_table);
 
@@ -372,6 +431,7 @@ context_fini(void)
     sbuf_fini(self->chilling_symbol_tables);
 
     freeze_fini();
+    source_fini();
 
     memset(self, 0x00, sizeof(*self));
 }
@@ -391,9 +451,17 @@ load_module(char const* name, char const* path)
     struct module* const module = module_new(name, path);
     sbuf_push(s_context.modules, module);
 
+    enum phase suspended = phase_enter(PHASE_PARSE);
     parse(module);
+    phase_leave(suspended);
+
+    suspended = phase_enter(PHASE_ORDER);
     order(module);
+    phase_leave(suspended);
+
+    suspended = phase_enter(PHASE_RESOLVE);
     resolve(module);
+    phase_leave(suspended);
 
     module->loaded = true;
     return module;
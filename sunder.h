@@ -616,17 +616,44 @@ source_line_start(char const* ptr);
 char const*
 source_line_end(char const* ptr);
 
+// Compact source location. Every source registered with source_register is
+// assigned a contiguous range of location values, one for each character of
+// the source plus one for its NUL-terminator, so that a location identifies
+// both a source and a character offset within that source. Locations are
+// decoded into a path, line, column, and source character on demand with
+// source_location_decode.
+#define NO_LOCATION ((struct source_location){0u})
+struct source_location {
+    // Zero indicates no location.
+    uint32_t id;
+};
+// Register the NUL-terminated source text of count characters (excluding the
+// NUL-terminator) for the file with the provided path, returning the location
+// of the first character of the source. Locations of subsequent characters
+// are produced with source_location_offset. A NULL source with a zero count
+// registers a location with a path but no line or source character. This
+// function will cause a fatal error if the total amount of registered source
+// text exceeds the range of a source location.
+// NOTE: Source locations produced by the lexing phase will use a module's
+// `name` (i.e. non-canonical path) member for the source location path.
+struct source_location
+source_register(char const* path, char const* source, size_t count);
+// Returns the location offset characters after the provided location.
+struct source_location
+source_location_offset(struct source_location location, size_t offset);
+
 #define NO_PATH ((char const*)NULL)
 #define NO_LINE ((size_t)0u)
+#define NO_COLUMN ((size_t)0u)
 #define NO_PSRC ((char const*)NULL)
-#define NO_LOCATION ((struct source_location){NO_PATH, NO_LINE, NO_PATH})
-struct source_location {
+// Decoded source location.
+struct source_position {
     // Optional (NULL indicates no value).
-    // NOTE: Source locations produced by the lexing phase will use a module's
-    // `name` (i.e. non-canonical path) member for the source location path.
     char const* path;
     // Optional (zero indicates no value).
     size_t line;
+    // Optional (zero indicates no value).
+    size_t column;
     // Optional (NULL indicates no value) pointer to the source character
     // within the module specified by path. If non-NULL then a log-messages
     // will display the line in question with a caret pointing to this
@@ -638,6 +665,11 @@ struct source_location {
     // ```
     char const* psrc;
 };
+struct source_position
+source_location_decode(struct source_location location);
+// Deinitialize the registered sources.
+void
+source_fini(void);
 
 #if defined(__GNUC__) /* GCC and Clang */
 #    define MESSAGEF __attribute__((format(printf, 2, 3)))
@@ -679,6 +711,10 @@ xspawnvpw(char const* const* argv);
 char const* // interned
 getenv_with_default(char const* name, char const* default_);
 
+// Returns the current time of a monotonic clock in seconds.
+double
+monotonic_seconds(void);
+
 ////////////////////////////////////////////////////////////////////////////////
 //////// sunder.c //////////////////////////////////////////////////////////////
 // Global compiler state.
@@ -724,6 +760,8 @@ struct module {
     // stop if a NUL byte is encountered.
     char const* source;
     size_t source_count;
+    // Location of the first character of the module source.
+    struct source_location location;
 
     // Global symbols.
     struct symbol_table* symbols;
@@ -743,6 +781,26 @@ module_new(char const* name, char const* path);
 void
 module_del(struct module* self);
 
+// Compilation phases timed by `sunder-compile -t`.
+enum phase {
+    PHASE_LEX,
+    PHASE_PARSE,
+    PHASE_ORDER,
+    PHASE_RESOLVE,
+    PHASE_CODEGEN,
+    PHASE_BACKEND,
+    PHASE_COUNT,
+};
+char const*
+phase_to_cstr(enum phase phase);
+// Begin attributing elapsed time to the provided phase, suspending the active
+// phase. Returns the suspended phase, which is resumed by passing it to
+// phase_leave when the provided phase is complete.
+enum phase
+phase_enter(enum phase phase);
+void
+phase_leave(enum phase suspended);
+
 struct context {
     // Interned strings.
     struct {
@@ -845,6 +903,21 @@ struct context {
     // List of all types instantiated by the compiler.
     sbuf(struct type const*) types;
 
+    // Open-addressing hash set of the pointer, array, slice, and function
+    // types instantiated by type_unique_*, keyed on the type kind and the
+    // types and counts that make up the type, so that looking up an existing
+    // type does not require constructing and formatting the name of the type.
+    struct {
+        // NULL indicates the element is not in use.
+        sbuf(struct type const*) elements;
+        // Number of in-use elements.
+        size_t count;
+        // Number of lookups that found an existing type.
+        unsigned long hits;
+        // Number of lookups that instantiated a new type.
+        unsigned long misses;
+    } unique_types;
+
     // List of all symbols with static storage duration.
     sbuf(struct symbol const*) static_symbols;
 
@@ -887,6 +960,17 @@ struct context {
         // Location where the instantiation occurred.
         struct source_location location;
     } const* template_instantiation_chain;
+
+    // Cumulative time spent in each compilation phase. Time spent in a nested
+    // phase, such as parsing a module imported while resolving another
+    // module, is attributed only to the nested phase.
+    struct {
+        double seconds[PHASE_COUNT];
+        // Phase currently being timed, or PHASE_COUNT if no phase is active.
+        enum phase current;
+        // Time at which the current phase was last entered or resumed.
+        double since;
+    } timing;
 };
 void
 context_init(void);
@@ -1839,6 +1923,11 @@ struct address {
             // True if this local corresponds to a function parameter.
             // Initialized to false within `address_init_local`.
             bool is_parameter;
+            // True if this local is assigned its initial value by its
+            // declaration before any use of the local (i.e. the local is a
+            // variable declared with an initializer other than uninit).
+            // Initialized to false within `address_init_local`.
+            bool is_initialized;
         } local;
     } data;
 };
@@ -2321,6 +2410,9 @@ object_new(
     struct value const* value);
 
 struct function {
+    // Fully qualified Sunder name of the function, including template
+    // arguments, e.g. `std::slice[[byte]]::new`.
+    char const* name; // interned
     struct type const* type; // TYPE_FUNCTION
     struct address const* address; // ADDRESS_STATIC
     // The value associated with this function. Self-referential, this member
@@ -2352,7 +2444,8 @@ struct function {
 // The type of the function must be of kind TYPE_FUNCTION.
 // The address of the function must be of kind ADDRESS_STATIC.
 struct function*
-function_new(struct type const* type, struct address const* address);
+function_new(
+    char const* name, struct type const* type, struct address const* address);
 
 struct value {
     struct type const* type;
@@ -2478,24 +2571,65 @@ eval_lvalue(struct expr const* expr);
 void
 codegen(
     bool opt_c,
+    bool opt_flto,
+    bool opt_fprofile_generate,
+    char const* opt_fprofile_use,
+    bool opt_fno_bounds_checks,
+    bool opt_fno_overflow_checks,
     bool opt_g,
     bool opt_k,
+    bool opt_m,
+    bool opt_p,
+    bool opt_s,
     char const* const* opt_L,
     char const* const* opt_l,
     char const* const opt_o);
+// Returns true if the `-l` option OPT is passed to the linker unchanged rather
+// than as a `-l` library name. This is the case for linker options, which
+// begin with `-`, and for input files: paths containing `/` and names of
+// object files, archives, and shared libraries (`.o`, `.a`, `.so`, `.so.N`).
+bool
+is_raw_linker_argument(char const* opt);
+// Write a perf map listing the start address, size, and Sunder name of every
+// function defined in the linked executable at exe_path into map_path. The
+// symbol_name function returns the interned name of the symbol table entry of
+// a function symbol in the executable. Returns a non-zero value and prints an
+// error on failure.
+// https://github.com/torvalds/linux/blob/master/tools/perf/Documentation/jit-interface.txt
+int
+write_perf_map(
+    char const* exe_path,
+    char const* map_path,
+    char const* (*symbol_name)(struct symbol const* symbol));
 void
 codegen_c(
     bool opt_c,
+    bool opt_flto,
+    bool opt_fprofile_generate,
+    char const* opt_fprofile_use,
+    bool opt_fno_bounds_checks,
+    bool opt_fno_overflow_checks,
     bool opt_g,
     bool opt_k,
+    bool opt_m,
+    bool opt_p,
+    bool opt_s,
     char const* const* opt_L,
     char const* const* opt_l,
     char const* const opt_o);
 void
 codegen_nasm(
     bool opt_c,
+    bool opt_flto,
+    bool opt_fprofile_generate,
+    char const* opt_fprofile_use,
+    bool opt_fno_bounds_checks,
+    bool opt_fno_overflow_checks,
     bool opt_g,
     bool opt_k,
+    bool opt_m,
+    bool opt_p,
+    bool opt_s,
     char const* const* opt_L,
     char const* const* opt_l,
     char const* const opt_o);
@@ -7,6 +7,7 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h> /* clock_gettime */
 
 #include <dirent.h> /* DIR, *dir-family */
 #include <libgen.h> /* dirname */
@@ -2130,9 +2131,8 @@ read_source(char const* path)
     void* text = NULL;
     size_t text_size = 0;
     if (file_read_all(path, &text, &text_size)) {
-        struct source_location const location = {path, NO_LINE, NO_PSRC};
         fatal(
-            location,
+            source_register(path, NULL, 0u),
             "failed to read '%s' with error '%s'",
             path,
             strerror(errno));
@@ -2175,6 +2175,127 @@ source_line_end(char const* ptr)
     return ptr;
 }
 
+// Source registered with source_register occupying the source location range
+// [base, base + count].
+struct source_file {
+    char const* path;
+    // NULL if the source was registered without source text.
+    char const* start;
+    size_t count;
+    uint32_t base;
+    // Offset of the first character of each line within the source, computed
+    // the first time a location within the source is decoded.
+    sbuf(size_t) lines;
+};
+// List of registered sources ordered by base location.
+static sbuf(struct source_file) source_files = NULL;
+
+struct source_location
+source_register(char const* path, char const* source, size_t count)
+{
+    assert(path != NULL);
+    assert(source != NULL || count == 0);
+
+    uint32_t base = 1u; // Location zero is reserved for NO_LOCATION.
+    if (sbuf_count(source_files) != 0) {
+        struct source_file const* const last =
+            &source_files[sbuf_count(source_files) - 1];
+        base = last->base + (uint32_t)last->count + 1u;
+    }
+
+    // One location for each character plus one for the NUL-terminator.
+    if ((uint64_t)base + (uint64_t)count >= (uint64_t)UINT32_MAX) {
+        fatal(
+            NO_LOCATION,
+            "failed to load '%s' (total source text exceeds %" PRIu32
+            " bytes)",
+            path,
+            UINT32_MAX);
+    }
+
+    struct source_file const file = {path, source, count, base, NULL};
+    sbuf_push(source_files, file);
+    return (struct source_location){base};
+}
+
+struct source_location
+source_location_offset(struct source_location location, size_t offset)
+{
+    assert(location.id != NO_LOCATION.id);
+    assert(offset < (size_t)(UINT32_MAX - location.id));
+
+    return (struct source_location){location.id + (uint32_t)offset};
+}
+
+struct source_position
+source_location_decode(struct source_location location)
+{
+    if (location.id == NO_LOCATION.id) {
+        return (struct source_position){NO_PATH, NO_LINE, NO_COLUMN, NO_PSRC};
+    }
+
+    // Binary search for the last source with a base at or before location.
+    assert(sbuf_count(source_files) != 0);
+    size_t lo = 0;
+    size_t hi = sbuf_count(source_files);
+    while (hi - lo > 1) {
+        size_t const mid = lo + (hi - lo) / 2;
+        if (source_files[mid].base <= location.id) {
+            lo = mid;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    struct source_file* const file = &source_files[lo];
+    assert(file->base <= location.id);
+    assert(location.id - file->base <= file->count);
+
+    if (file->start == NULL) {
+        return (struct source_position){
+            file->path, NO_LINE, NO_COLUMN, NO_PSRC};
+    }
+
+    if (file->lines == NULL) {
+        sbuf_push(file->lines, 0u);
+        for (size_t i = 0; i < file->count; ++i) {
+            if (file->start[i] == '\n') {
+                sbuf_push(file->lines, i + 1);
+            }
+        }
+    }
+
+    // Binary search for the last line starting at or before location.
+    size_t const offset = location.id - file->base;
+    lo = 0;
+    hi = sbuf_count(file->lines);
+    while (hi - lo > 1) {
+        size_t const mid = lo + (hi - lo) / 2;
+        if (file->lines[mid] <= offset) {
+            lo = mid;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    return (struct source_position){
+        file->path,
+        lo + 1,
+        offset - file->lines[lo] + 1,
+        file->start + offset,
+    };
+}
+
+void
+source_fini(void)
+{
+    for (size_t i = 0; i < sbuf_count(source_files); ++i) {
+        sbuf_fini(source_files[i].lines);
+    }
+    sbuf_fini(source_files);
+}
+
 static void
 messagev(
     bool show_template_instantiation_stack,
@@ -2189,26 +2310,28 @@ messagev(
     assert(fmt != NULL);
 
     bool const is_tty = isatty(STDERR_FILENO);
+    struct source_position const position =
+        source_location_decode(location);
 
-    if (location.path != NO_PATH || location.line != NO_LINE) {
+    if (position.path != NO_PATH || position.line != NO_LINE) {
         fprintf(stderr, "[");
 
-        if (location.path != NO_PATH) {
+        if (position.path != NO_PATH) {
             char const* const path_ansi_beg = is_tty ? ANSI_ESC_CYAN : "";
             char const* const path_ansi_end = is_tty ? ANSI_ESC_DEFAULT : "";
             fprintf(
-                stderr, "%s%s%s", path_ansi_beg, location.path, path_ansi_end);
+                stderr, "%s%s%s", path_ansi_beg, position.path, path_ansi_end);
         }
 
-        if (location.path != NO_PATH && location.line != NO_LINE) {
+        if (position.path != NO_PATH && position.line != NO_LINE) {
             fputc(':', stderr);
         }
 
-        if (location.line != NO_LINE) {
+        if (position.line != NO_LINE) {
             char const* const line_ansi_beg = is_tty ? ANSI_ESC_CYAN : "";
             char const* const line_ansi_end = is_tty ? ANSI_ESC_DEFAULT : "";
             fprintf(
-                stderr, "%s%zu%s", line_ansi_beg, location.line, line_ansi_end);
+                stderr, "%s%zu%s", line_ansi_beg, position.line, line_ansi_end);
         }
 
         fprintf(stderr, "] ");
@@ -2221,13 +2344,13 @@ messagev(
     vfprintf(stderr, fmt, args);
     fputs("\n", stderr);
 
-    if (location.psrc != NO_PSRC && *location.psrc != '\0') {
-        assert(location.path != NULL);
-        char const* const line_start = source_line_start(location.psrc);
-        char const* const line_end = source_line_end(location.psrc);
+    if (position.psrc != NO_PSRC && *position.psrc != '\0') {
+        assert(position.path != NULL);
+        char const* const line_start = source_line_start(position.psrc);
+        char const* const line_end = source_line_end(position.psrc);
 
         fprintf(stderr, "%.*s\n", (int)(line_end - line_start), line_start);
-        fprintf(stderr, "%*s^\n", (int)(location.psrc - line_start), "");
+        fprintf(stderr, "%*s^\n", (int)(position.psrc - line_start), "");
     }
 
     if (!show_template_instantiation_stack) {
@@ -2359,3 +2482,16 @@ getenv_with_default(char const* name, char const* default_)
     }
     return intern_cstr(s);
 }
+
+double
+monotonic_seconds(void)
+{
+    struct timespec ts = {0};
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        fatal(
+            NO_LOCATION,
+            "failed to read monotonic clock with error '%s'",
+            strerror(errno));
+    }
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}